@@ -0,0 +1,81 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+/// @brief Unbounded lock-free multi-producer single-consumer queue (intrusive Vyukov queue).
+/// Carries the reactor's posted tasks and the server's staged updates and monitor events.
+/// push() is one atomic exchange and never waits, so it is cheap enough to call with a lock
+/// held; pop() may only be called by one thread.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(&stub), tail(&stub) { stub.next.store(nullptr, std::memory_order_relaxed); }
+
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /// @brief Appends a value. Safe to call from any number of threads.
+    /// @param value The value to append.
+    void push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        pushNode(node);
+    }
+
+    /// @brief Removes the oldest value. Only the consumer thread may call this.
+    /// @param value Receives the value.
+    /// @return false if the queue is empty, or a producer is halfway through a push
+    ///         (that producer's own wakeup brings the consumer back).
+    bool pop(T& value) {
+        Node* last = tail;
+        Node* next = last->next.load(std::memory_order_acquire);
+        if (last == &stub) { // Skip over the sentinel
+            if (next == nullptr) {
+                return false;
+            }
+            tail = next;
+            last = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next == nullptr) {
+            if (last != head.load(std::memory_order_acquire)) {
+                return false; // A producer has swapped the head but not linked it yet
+            }
+            pushNode(&stub); // Re-insert the sentinel so the last node can be detached
+            next = last->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return false;
+            }
+        }
+        tail = next;
+        value = std::move(last->value);
+        delete last;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    void pushNode(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel); // Become the new head
+        prev->next.store(node, std::memory_order_release);           // Link the previous head to us
+    }
+
+    std::atomic<Node*> head; ///< Most recently pushed node (producers).
+    Node* tail;              ///< Oldest node (consumer only).
+    Node stub;               ///< Sentinel keeping the list non-empty.
+};
+
+#endif // MPSC_QUEUE_HPP
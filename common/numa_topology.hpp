@@ -0,0 +1,226 @@
+#ifndef NUMA_TOPOLOGY_HPP
+#define NUMA_TOPOLOGY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+/*
+NUMA placement without libnuma.
+
+On a multi-socket machine each memory page lives on the node of the thread that first touches
+it. A graph built by one thread therefore sits on one node, and threads on the other sockets
+reach it through the interconnect at a fraction of the local bandwidth. The helpers below read
+the nodes and their CPUs from sysfs, place memory with mbind() (spread page by page over every
+node, or on one node) and pin threads to the CPUs of a node. On a machine with a single node,
+or when sysfs or mbind() is unavailable, they do nothing.
+*/
+
+/// @brief How the memory of a graph is spread over the NUMA nodes.
+enum class NumaPlacement {
+    FirstTouch,  ///< Wherever the building thread runs (the kernel default).
+    Interleave,  ///< Page by page over every node: no node is a hot spot whoever traverses.
+    Partition    ///< Vertex range k on node k: a thread working on a range finds it local.
+};
+
+/// @brief Parses the name of a placement ("first", "interleave" or "partition").
+/// @param name The name.
+/// @param placement Set to the placement on success.
+/// @return true if the name is known.
+inline bool parseNumaPlacement(const std::string& name, NumaPlacement& placement) {
+    if (name == "first") {
+        placement = NumaPlacement::FirstTouch;
+    } else if (name == "interleave") {
+        placement = NumaPlacement::Interleave;
+    } else if (name == "partition") {
+        placement = NumaPlacement::Partition;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// @brief Parses a sysfs CPU or node list such as "0-3,8-11".
+/// @param text The list.
+/// @return The ids, in the order listed.
+inline std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> ids;
+    size_t i = 0;
+    while (i < text.size()) {
+        size_t comma = text.find(',', i);
+        std::string range = text.substr(i, comma == std::string::npos ? std::string::npos : comma - i);
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range);
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int id = first; id <= last; ++id) {
+                ids.push_back(id);
+            }
+        } catch (...) { // Blank or malformed: skip it
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        i = comma + 1;
+    }
+    return ids;
+}
+
+/// @brief The NUMA nodes of the machine and the CPUs of each, as listed in /sys/devices/system/node.
+class NumaTopology {
+public:
+    /// @brief Topology of this machine, read once.
+    static const NumaTopology& get() {
+        static const NumaTopology topology;
+        return topology;
+    }
+
+    /// @brief Number of nodes (1 when sysfs lists none).
+    int numNodes() const { return static_cast<int>(nodeIds.size()); }
+
+    /// @brief Kernel id of a node (nodes are numbered 0..numNodes() - 1 here, the kernel may skip ids).
+    int nodeId(int node) const { return nodeIds[node]; }
+
+    /// @brief CPUs of a node (empty if unknown: any CPU).
+    const std::vector<int>& cpus(int node) const { return nodeCpus[node]; }
+
+    /// @brief Node of an item when count items (workers, chunks, vertices) are split into
+    /// numNodes() contiguous ranges, range k on node k.
+    /// @param index The item (0-based, below count).
+    /// @param count Number of items.
+    int nodeOf(size_t index, size_t count) const {
+        return count == 0 ? 0 : static_cast<int>(index * nodeIds.size() / count);
+    }
+
+private:
+    NumaTopology() {
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        if (online && std::getline(online, list)) {
+            nodeIds = parseCpuList(list);
+        }
+        for (int id : nodeIds) {
+            std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            std::string cpus;
+            std::getline(cpulist, cpus);
+            nodeCpus.push_back(parseCpuList(cpus));
+        }
+        if (nodeIds.empty()) { // No NUMA support in the kernel: one node with every CPU
+            nodeIds.push_back(0);
+            nodeCpus.push_back(std::vector<int>());
+        }
+    }
+
+    std::vector<int> nodeIds;                ///< Kernel id of each node.
+    std::vector<std::vector<int>> nodeCpus;  ///< CPUs of each node.
+};
+
+/// @brief Applies a memory policy to the whole pages of a range, moving the pages already touched.
+/// Partial pages at either end are left alone: they are shared with neighboring data.
+/// @param memory Start of the range.
+/// @param bytes Length of the range.
+/// @param mode MPOL_INTERLEAVE or MPOL_PREFERRED.
+/// @param nodes Kernel ids of the nodes.
+/// @return true if applied (or there is nothing to apply).
+inline bool applyMemoryPolicy(const void* memory, size_t bytes, int mode, const std::vector<int>& nodes) {
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t first = (reinterpret_cast<uintptr_t>(memory) + pageSize - 1) & ~(pageSize - 1);
+    uintptr_t last = (reinterpret_cast<uintptr_t>(memory) + bytes) & ~(pageSize - 1);
+    if (first >= last) {
+        return true;
+    }
+    const size_t maskBits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(1);
+    for (int node : nodes) {
+        if (static_cast<size_t>(node) / maskBits >= mask.size()) {
+            mask.resize(node / maskBits + 1, 0);
+        }
+        mask[node / maskBits] |= 1UL << (node % maskBits);
+    }
+    return syscall(SYS_mbind, first, last - first, mode, mask.data(), mask.size() * maskBits + 1, MPOL_MF_MOVE) == 0;
+}
+
+/// @brief Spreads the pages of a range over every node. Does nothing with a single node.
+/// @param memory Start of the range.
+/// @param bytes Length of the range.
+/// @return true if applied (or there is nothing to apply).
+inline bool interleaveMemory(const void* memory, size_t bytes) {
+    const NumaTopology& topology = NumaTopology::get();
+    if (topology.numNodes() < 2) {
+        return true;
+    }
+    std::vector<int> nodes;
+    for (int node = 0; node < topology.numNodes(); ++node) {
+        nodes.push_back(topology.nodeId(node));
+    }
+    return applyMemoryPolicy(memory, bytes, MPOL_INTERLEAVE, nodes);
+}
+
+/// @brief Places the pages of a range on one node, falling back to others when it is full.
+/// Does nothing with a single node.
+/// @param memory Start of the range.
+/// @param bytes Length of the range.
+/// @param node The node (0..numNodes() - 1).
+/// @return true if applied (or there is nothing to apply).
+inline bool placeMemoryOnNode(const void* memory, size_t bytes, int node) {
+    const NumaTopology& topology = NumaTopology::get();
+    if (topology.numNodes() < 2) {
+        return true;
+    }
+    return applyMemoryPolicy(memory, bytes, MPOL_PREFERRED, std::vector<int>(1, topology.nodeId(node)));
+}
+
+/// @brief Places an array whose element i belongs to vertex range nodeOf(i, count) on that range's node.
+/// @param items The array.
+/// @param count Number of elements.
+template <typename T>
+inline void partitionMemory(const T* items, size_t count) {
+    const NumaTopology& topology = NumaTopology::get();
+    for (int node = 0; node < topology.numNodes() && topology.numNodes() > 1; ++node) {
+        size_t first = count * node / topology.numNodes();
+        size_t last = count * (node + 1) / topology.numNodes();
+        placeMemoryOnNode(items + first, (last - first) * sizeof(T), node);
+    }
+}
+
+/// @brief Places an array according to a placement (FirstTouch leaves it alone).
+/// @param items The array.
+/// @param count Number of elements.
+/// @param placement The placement.
+template <typename T>
+inline void placeMemory(const T* items, size_t count, NumaPlacement placement) {
+    if (placement == NumaPlacement::Interleave) {
+        interleaveMemory(items, count * sizeof(T));
+    } else if (placement == NumaPlacement::Partition) {
+        partitionMemory(items, count);
+    }
+}
+
+/// @brief Restricts a thread to the CPUs of a node, so that memory placed there stays local.
+/// Does nothing with a single node or a node whose CPUs are unknown.
+/// @param thread The thread.
+/// @param node The node (0..numNodes() - 1).
+/// @return true if pinned (or there is nothing to pin).
+inline bool pinThreadToNode(pthread_t thread, int node) {
+    const NumaTopology& topology = NumaTopology::get();
+    if (topology.numNodes() < 2 || topology.cpus(node).empty()) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : topology.cpus(node)) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+#endif // NUMA_TOPOLOGY_HPP
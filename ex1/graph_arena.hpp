@@ -0,0 +1,151 @@
+#ifndef GRAPH_ARENA_HPP
+#define GRAPH_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+#include "../common/numa_topology.hpp"
+
+/// @brief Memory of one graph: list nodes and other small objects are carved out of large blocks.
+/// Building a graph only bumps a pointer; memory given back while the graph changes (a removed
+/// edge, a cleared SCC) goes to a free list per size and is reused by the next allocation of that
+/// size. Destroying the arena releases everything with one free() per block instead of one per
+/// node, so objects living in it need not be destroyed one by one.
+/// On a machine with several NUMA nodes the blocks can be placed (see NumaPlacement); they are
+/// then larger and mapped on their own, so that each takes one memory policy.
+class GraphArena {
+public:
+    static const size_t BLOCK_SIZE = 1 << 16;  ///< Bytes per block.
+    static const size_t PLACED_BLOCK_SIZE = 1 << 21;  ///< Bytes per block with a NUMA placement.
+    static const size_t ALIGNMENT = alignof(std::max_align_t);  ///< Sizes are rounded up to this.
+    static const size_t SIZE_CLASSES = 64;  ///< Sizes below SIZE_CLASSES * ALIGNMENT come from the blocks.
+
+    /// @param placement Where the blocks go: FirstTouch (the default), Interleave over every node,
+    ///                  or Partition, all on one node.
+    /// @param node The node for Partition (0..NumaTopology::numNodes() - 1).
+    explicit GraphArena(NumaPlacement placement = NumaPlacement::FirstTouch, int node = 0)
+        : placement(NumaTopology::get().numNodes() > 1 ? placement : NumaPlacement::FirstTouch), node(node), cursor(nullptr), end(nullptr) {
+        for (size_t i = 0; i < SIZE_CLASSES; ++i) {
+            freeLists[i] = nullptr;
+        }
+    }
+
+    GraphArena(const GraphArena&) = delete;
+    GraphArena& operator=(const GraphArena&) = delete;
+
+    ~GraphArena() {
+        for (char* block : blocks) {
+            if (placement == NumaPlacement::FirstTouch) {
+                ::operator delete(block);
+            } else {
+                munmap(block, PLACED_BLOCK_SIZE);
+            }
+        }
+    }
+
+    /// @brief Allocates memory, aligned for any type.
+    /// Large requests (vector buffers) go to the global heap and must be given back with deallocate().
+    /// @param bytes Number of bytes.
+    void* allocate(size_t bytes) {
+        size_t sizeClass = (bytes + ALIGNMENT - 1) / ALIGNMENT;
+        if (sizeClass >= SIZE_CLASSES) {
+            return ::operator new(bytes);
+        }
+        if (sizeClass == 0) {
+            sizeClass = 1;
+        }
+        if (freeLists[sizeClass]) { // Reuse memory given back
+            FreeSlot* slot = freeLists[sizeClass];
+            freeLists[sizeClass] = slot->next;
+            return slot;
+        }
+        size_t size = sizeClass * ALIGNMENT;
+        if (cursor == nullptr || static_cast<size_t>(end - cursor) < size) {
+            blocks.push_back(newBlock()); // The rest of the old block is left unused
+            cursor = blocks.back();
+            end = cursor + blockSize();
+        }
+        void* memory = cursor;
+        cursor += size;
+        return memory;
+    }
+
+    /// @brief Gives memory back for reuse.
+    /// @param memory Memory from allocate().
+    /// @param bytes The size passed to allocate().
+    void deallocate(void* memory, size_t bytes) {
+        size_t sizeClass = (bytes + ALIGNMENT - 1) / ALIGNMENT;
+        if (sizeClass >= SIZE_CLASSES) {
+            ::operator delete(memory);
+            return;
+        }
+        if (sizeClass == 0) {
+            sizeClass = 1;
+        }
+        FreeSlot* slot = static_cast<FreeSlot*>(memory);
+        slot->next = freeLists[sizeClass];
+        freeLists[sizeClass] = slot;
+    }
+
+    /// @brief Bytes held in blocks.
+    size_t reserved() const { return blocks.size() * blockSize(); }
+
+private:
+    size_t blockSize() const { return placement == NumaPlacement::FirstTouch ? BLOCK_SIZE : PLACED_BLOCK_SIZE; }
+
+    // Allocates a block, placed before any of its pages is touched.
+    char* newBlock() {
+        if (placement == NumaPlacement::FirstTouch) {
+            return static_cast<char*>(::operator new(BLOCK_SIZE));
+        }
+        void* block = mmap(nullptr, PLACED_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (block == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (placement == NumaPlacement::Interleave) {
+            interleaveMemory(block, PLACED_BLOCK_SIZE);
+        } else {
+            placeMemoryOnNode(block, PLACED_BLOCK_SIZE, node);
+        }
+        return static_cast<char*>(block);
+    }
+
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    NumaPlacement placement;              ///< Placement of the blocks (FirstTouch with a single node).
+    int node;                             ///< Node of the blocks for Partition.
+    std::vector<char*> blocks;            ///< Every block allocated so far.
+    char* cursor;                         ///< Next free byte of the current block.
+    char* end;                            ///< End of the current block.
+    FreeSlot* freeLists[SIZE_CLASSES];    ///< Memory given back, per size class.
+};
+
+/// @brief Standard allocator drawing from a GraphArena, for the containers of a graph.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    /// @param arena The arena; must outlive every container using the allocator.
+    explicit ArenaAllocator(GraphArena* arena) : arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T))); }
+
+    void deallocate(T* memory, size_t n) { arena->deallocate(memory, n * sizeof(T)); }
+
+    GraphArena* arena; ///< The arena allocated from.
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right) { return left.arena == right.arena; }
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right) { return left.arena != right.arena; }
+
+#endif // GRAPH_ARENA_HPP
@@ -4,10 +4,10 @@
 Node::Node(int data) : data(data), next(nullptr) {}
 
 // LinkedList class implementation
-LinkedList::LinkedList() : head(nullptr) {}
+LinkedList::LinkedList(GraphArena* arena) : head(nullptr), arena(arena) {}
 
 void LinkedList::push(int data) {
-    Node* newNode = new Node(data);  // Create a new node with the given data
+    Node* newNode = arena ? new (arena->allocate(sizeof(Node))) Node(data) : new Node(data);  // Create a new node with the given data
     newNode->next = head;  // Point the new node's next to the current head
     head = newNode;  // Update the head to the new node
 }
@@ -16,7 +16,11 @@ void LinkedList::clear() {
     while (head) {
         Node* temp = head;  // Store the current head in a temporary pointer
         head = head->next;  // Move the head to the next node
-        delete temp;  // Delete the old head
+        if (arena) {
+            arena->deallocate(temp, sizeof(Node));  // Give the old head back for reuse
+        } else {
+            delete temp;  // Delete the old head
+        }
     }
 }
 
@@ -54,6 +58,9 @@ const std::vector<LinkedList>& KosarajuLinkedList::getSCCs() const {
         3) Print the SCCs
 */
 void KosarajuLinkedList::findSCCs() {
+    for (auto& scc : sccs) {
+        scc.clear(); // The previous run's nodes go back to the arena
+    }
     sccs.clear(); // Clear the SCCs vector before finding SCCs
     fill(visited.begin(), visited.end(), false); // Reset the visited vector
     while (!finishStack.empty()) {
@@ -84,7 +91,7 @@ void KosarajuLinkedList::findSCCs() {
         int node = finishStack.top();  // Get the top node from the finish stack
         finishStack.pop();  // Remove the top node from the stack
         if (!visited[node]) {
-            LinkedList scc;  // Create a new linked list to store the SCC
+            LinkedList scc(&arena);  // Create a new linked list to store the SCC
             dfsSecondPass(node, scc);  // Perform DFS to collect nodes in the SCC
             sccs.push_back(scc);  // Add the SCC to the list of SCCs
         }
@@ -116,7 +123,7 @@ void KosarajuLinkedList::printSCCs() const {
 
 
 void KosarajuLinkedList::addEdge(Node*& head, int data) {
-    Node* newNode = new Node(data);  // Create a new node with the given data
+    Node* newNode = new (arena.allocate(sizeof(Node))) Node(data);  // Create a new node with the given data (freed with the arena)
     newNode->next = head;  // Point the new node's next to the current head
     head = newNode;  // Update the head to the new node
 }
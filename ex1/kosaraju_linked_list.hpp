@@ -5,6 +5,7 @@
 #include <stack>
 #include <vector>
 #include <list>
+#include "graph_arena.hpp"
 
 using namespace std;
 
@@ -23,9 +24,11 @@ public:
 class LinkedList {
 public:
     Node* head;
+    GraphArena* arena;  // Where the nodes are allocated (nullptr: with new)
 
     /// @brief Constructor to initialize an empty LinkedList
-    LinkedList();
+    /// @param arena Arena to allocate the nodes from, or nullptr to use new
+    LinkedList(GraphArena* arena = nullptr);
 
     /// @brief Pushes a new data value onto the front of the list
     /// @param data The data to be added to the list
@@ -55,6 +58,7 @@ public:
     void printSCCs() const;
 
 private:
+    GraphArena arena;  // Memory of every Node of the graph and its SCCs, released at once with the graph
     int n;  // Number of nodes
     vector<Node*> graph;  // Adjacency list of the graph
     vector<Node*> transposedGraph;  // Adjacency list of the transposed graph
@@ -0,0 +1,79 @@
+#include "data_dir.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+using namespace std;
+
+/// Canonical path of the data directory (no symbolic links, no trailing slash)
+static string dataRoot;
+
+// Canonical form of an existing path, or "" if it cannot be resolved.
+static string canonicalPath(const string& path) {
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) ? string(resolved) : string();
+}
+
+// Whether a canonical path is the data directory or lies below it.
+static bool insideDataRoot(const string& path) {
+    if (path == dataRoot || dataRoot == "/") {
+        return !path.empty();
+    }
+    return path.compare(0, dataRoot.size(), dataRoot) == 0 && path.size() > dataRoot.size() && path[dataRoot.size()] == '/';
+}
+
+bool setDataDirectory(const string& dir, string& error) {
+    struct stat info;
+    string root = canonicalPath(dir);
+    if (root.empty() || stat(root.c_str(), &info) < 0) {
+        error = dir + ": " + strerror(errno);
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        error = dir + ": " + strerror(ENOTDIR);
+        return false;
+    }
+    dataRoot = root;
+    return true;
+}
+
+bool resolveDataPath(const string& name, string& path, string& error) {
+    if (dataRoot.empty() && !setDataDirectory(".", error)) {
+        return false;
+    }
+    if (name.empty() || name[0] == '/') {
+        error = name + ": absolute paths are not allowed";
+        return false;
+    }
+    size_t start = 0;
+    while (start <= name.size()) { // Refuse every ".." component, wherever it is
+        size_t slash = name.find('/', start);
+        size_t end = slash == string::npos ? name.size() : slash;
+        if (name.compare(start, end - start, "..") == 0) {
+            error = name + ": \"..\" is not allowed";
+            return false;
+        }
+        start = end + 1;
+    }
+    if (name.back() == '/') {
+        error = name + ": not a file name";
+        return false;
+    }
+
+    path = dataRoot + "/" + name;
+    size_t slash = path.rfind('/');
+    string parent = canonicalPath(path.substr(0, slash)); // Follows any link among the directories
+    if (parent.empty()) {
+        error = name + ": " + strerror(errno);
+        return false;
+    }
+    struct stat info;
+    string target = lstat(path.c_str(), &info) == 0 ? canonicalPath(path) : parent; // Follows a link at the file itself
+    if (!insideDataRoot(parent) || target.empty() || !insideDataRoot(target)) {
+        error = name + ": outside the data directory";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef DATA_DIR_HPP
+#define DATA_DIR_HPP
+
+#include <string>
+
+/*
+The directory holding the files clients name in their commands (SAVE, LOAD, Closure, ExternalSCC).
+
+A client sends only a name relative to it: absolute paths and ".." components are refused, and
+a name that resolves outside the directory through a symbolic link is refused too, so no client
+reaches any other file the server process could read or overwrite.
+*/
+
+/// @brief Sets the data directory. Called once, before any client is served.
+/// @param dir The directory (the server's working directory if never called).
+/// @param error Set to the reason on failure.
+/// @return true if dir is an existing directory.
+bool setDataDirectory(const std::string& dir, std::string& error);
+
+/// @brief Resolves a file name sent by a client to a path inside the data directory.
+/// The file itself need not exist, but the directory it would be in must.
+/// @param name The name sent by the client.
+/// @param path Set to the path to open.
+/// @param error Set to the reason on failure.
+/// @return true if the name stays inside the data directory.
+bool resolveDataPath(const std::string& name, std::string& path, std::string& error);
+
+#endif // DATA_DIR_HPP
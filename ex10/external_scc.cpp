@@ -0,0 +1,177 @@
+#include "external_scc.hpp"
+#include "graph_file.hpp"
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const size_t READ_BLOCK = 1 << 18;  // Elements read per pread() of a section
+static const long TRIM_MIN_SHARE = 100;    // Trim again only while it assigns at least 1/100 of the rest
+
+// Per-vertex flags
+static const uint8_t HAS_IN = 1;   // Has a remaining in-neighbor
+static const uint8_t HAS_OUT = 2;  // Has a remaining out-neighbor
+static const uint8_t REACHED = 4;  // Reaches the root of its color
+
+/// @brief Sequential reader of one section of a graph file, in large blocks.
+template <typename T>
+struct SectionReader {
+    int fd;           ///< The file.
+    long pos;         ///< File offset of the next block.
+    vector<T> block;  ///< Current block.
+    size_t index = 0; ///< Next element of block.
+    size_t count = 0; ///< Elements in block.
+
+    SectionReader(int fd, long pos) : fd(fd), pos(pos), block(READ_BLOCK) {}
+
+    bool next(T& value) {
+        if (index == count) {
+            ssize_t got = pread(fd, block.data(), block.size() * sizeof(T), pos);
+            if (got < static_cast<ssize_t>(sizeof(T))) {
+                return false;
+            }
+            count = got / sizeof(T);
+            index = 0;
+            pos += count * sizeof(T);
+        }
+        value = block[index++];
+        return true;
+    }
+};
+
+// One sequential pass: calls visit(u, v) for every edge u -> v of the file (0-based).
+// Returns false if the file turns out to be short or damaged.
+template <typename Visit>
+static bool scanEdges(int fd, const GraphFileLayout& layout, long& passes, Visit visit) {
+    SectionReader<int64_t> offsets(fd, layout.offsetsAt);
+    SectionReader<int32_t> targets(fd, layout.targetsAt);
+    int64_t begin = 0, end = 0;
+    if (!offsets.next(begin)) {
+        return false;
+    }
+    for (int u = 0; u < layout.n; ++u) {
+        if (!offsets.next(end) || end < begin) {
+            return false;
+        }
+        for (int64_t i = begin; i < end; ++i) {
+            int32_t v;
+            if (!targets.next(v) || v < 0 || v >= layout.n) {
+                return false;
+            }
+            visit(u, v);
+        }
+        begin = end;
+    }
+    passes++;
+    return true;
+}
+
+bool externalSCCs(const string& path, ExternalSccResult& result, string& error) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    GraphFileLayout layout;
+    if (!readGraphFileLayout(fd, layout, error)) {
+        error = path + ": " + error;
+        close(fd);
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    int n = layout.n;
+    vector<int>& component = result.componentOf;
+    component.assign(n, -1);
+    vector<int> color(n);
+    vector<uint8_t> flags(n);
+    long remaining = n;
+    result.passes = 0;
+    result.edges = layout.m;
+    bool ok = true;
+
+    while (ok && remaining > 0) {
+        // Trim vertices that cannot be on a cycle with another remaining vertex
+        while (ok && remaining > 0) {
+            for (int v = 0; v < n; ++v) {
+                flags[v] = 0;
+            }
+            ok = scanEdges(fd, layout, result.passes, [&](int u, int v) {
+                if (u != v && component[u] < 0 && component[v] < 0) {
+                    flags[u] |= HAS_OUT;
+                    flags[v] |= HAS_IN;
+                }
+            });
+            long trimmed = 0;
+            for (int v = 0; v < n; ++v) {
+                if (component[v] < 0 && flags[v] != (HAS_IN | HAS_OUT)) {
+                    component[v] = v;
+                    trimmed++;
+                }
+            }
+            remaining -= trimmed;
+            if (trimmed == 0 || trimmed < remaining / TRIM_MIN_SHARE) {
+                break;
+            }
+        }
+        if (!ok || remaining == 0) {
+            break;
+        }
+
+        // Color: the largest id among the remaining vertices reaching each vertex
+        for (int v = 0; v < n; ++v) {
+            color[v] = v;
+        }
+        bool changed = true;
+        while (ok && changed) {
+            changed = false;
+            ok = scanEdges(fd, layout, result.passes, [&](int u, int v) {
+                if (component[u] < 0 && component[v] < 0 && color[u] > color[v]) {
+                    color[v] = color[u];
+                    changed = true;
+                }
+            });
+        }
+
+        // Reach back from every root within its color: that is the root's SCC
+        for (int v = 0; v < n; ++v) {
+            flags[v] = color[v] == v ? REACHED : 0;
+        }
+        changed = true;
+        while (ok && changed) {
+            changed = false;
+            ok = scanEdges(fd, layout, result.passes, [&](int u, int v) {
+                if ((flags[v] & REACHED) && !(flags[u] & REACHED) && color[u] == color[v] && component[u] < 0 && component[v] < 0) {
+                    flags[u] |= REACHED;
+                    changed = true;
+                }
+            });
+        }
+        for (int v = 0; v < n; ++v) {
+            if (component[v] < 0 && (flags[v] & REACHED)) {
+                component[v] = color[v];
+                remaining--;
+            }
+        }
+    }
+    close(fd);
+    if (!ok) {
+        error = path + ": truncated or damaged graph file";
+        return false;
+    }
+
+    // Sizes, counted in color (no longer needed)
+    fill(color.begin(), color.end(), 0);
+    result.components = 0;
+    result.largest = 0;
+    for (int v = 0; v < n; ++v) {
+        if (color[component[v]]++ == 0) {
+            result.components++;
+        }
+        result.largest = max(result.largest, color[component[v]]);
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef EXTERNAL_SCC_HPP
+#define EXTERNAL_SCC_HPP
+
+#include <string>
+#include <vector>
+
+/*
+Semi-external SCCs of a graph file (as written by SAVE) that need not fit in memory.
+
+Only per-vertex state is kept in RAM - about 9 bytes per vertex - while the edges are streamed
+from the file in sequential passes. The algorithm works in rounds over the vertices not yet
+assigned to an SCC:
+
+1. Trim: a vertex without a remaining in-neighbor or out-neighbor is an SCC of its own.
+   Repeated while it peels off a noticeable share of the vertices.
+2. Color: every vertex takes the largest id among the remaining vertices that reach it
+   (passes until nothing changes). A vertex whose color is its own id is a root.
+3. Reach back: the SCC of a root is the vertices of its color that reach it, found by
+   passes over the edges restricted to that color.
+
+Each round assigns at least the vertex with the largest remaining id; on real graphs a few
+rounds assign nearly everything. Long chains of small SCCs are the bad case: they take about
+one pass per link.
+*/
+
+/// @brief SCCs computed by externalSCCs().
+struct ExternalSccResult {
+    std::vector<int> componentOf; ///< SCC of each vertex, as the id of one of its vertices (0-based).
+    int components = 0;           ///< Number of SCCs.
+    int largest = 0;              ///< Size of the largest SCC.
+    long passes = 0;              ///< Sequential passes made over the edges.
+    long edges = 0;               ///< Number of edges in the file.
+};
+
+/// @brief Computes the SCCs of a graph file, streaming its edges instead of loading them.
+/// @param path Path of the graph file.
+/// @param result Filled with the SCCs.
+/// @param error Set to the reason on failure.
+/// @return true on success.
+bool externalSCCs(const std::string& path, ExternalSccResult& result, std::string& error);
+
+#endif // EXTERNAL_SCC_HPP
@@ -0,0 +1,199 @@
+#include "graph_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const char GRAPH_FILE_MAGIC[8] = {'K', 'S', 'C', 'S', 'R', 0, 0, 0};
+static const uint32_t GRAPH_FILE_VERSION = 1;
+
+/// @brief Fixed-size start of a graph file.
+struct GraphFileHeader {
+    char magic[8];    ///< GRAPH_FILE_MAGIC.
+    uint32_t version; ///< GRAPH_FILE_VERSION.
+    uint32_t flags;   ///< GRAPH_FILE_SCC_IDS or 0.
+    int64_t n;        ///< Number of vertices.
+    int64_t m;        ///< Number of edges.
+};
+
+// Rounds a section length up to the 8-byte alignment of the next section.
+static size_t aligned(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+// Writes one CSR direction: offsets, then targets padded to 8 bytes.
+static void writeCsr(FILE* file, const GraphSnapshot& snapshot, bool reverse) {
+    int n = snapshot.getNumVertices();
+    int64_t offset = 0;
+    fwrite(&offset, sizeof(offset), 1, file);
+    for (int i = 0; i < n; ++i) {
+        offset += (reverse ? snapshot.reverseNeighbors(i) : snapshot.neighbors(i)).size();
+        fwrite(&offset, sizeof(offset), 1, file);
+    }
+    for (int i = 0; i < n; ++i) {
+        const vector<int>& list = reverse ? snapshot.reverseNeighbors(i) : snapshot.neighbors(i);
+        fwrite(list.data(), sizeof(int32_t), list.size(), file);
+    }
+    static const char padding[8] = {};
+    fwrite(padding, 1, aligned(offset * sizeof(int32_t)) - offset * sizeof(int32_t), file);
+}
+
+bool saveGraphFile(const string& path, const GraphSnapshot& snapshot, const vector<int>* componentIds, string& error) {
+    string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0644); // Never written through a link
+    FILE* file = fd < 0 ? nullptr : fdopen(fd, "wb");
+    if (!file) {
+        error = tmpPath + ": " + strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    vector<char> fileBuffer(1 << 20);
+    setvbuf(file, fileBuffer.data(), _IOFBF, fileBuffer.size());
+
+    GraphFileHeader header;
+    memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_FILE_VERSION;
+    header.flags = componentIds ? GRAPH_FILE_SCC_IDS : 0;
+    header.n = snapshot.getNumVertices();
+    header.m = 0;
+    for (int i = 0; i < header.n; ++i) {
+        header.m += snapshot.neighbors(i).size();
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    writeCsr(file, snapshot, false);
+    writeCsr(file, snapshot, true);
+    if (componentIds) {
+        fwrite(componentIds->data(), sizeof(int32_t), componentIds->size(), file);
+    }
+
+    bool ok = fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) < 0) {
+        error = path + ": " + strerror(errno);
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+MappedGraphFile::~MappedGraphFile() {
+    if (data) {
+        munmap(data, size);
+    }
+}
+
+// Checks one CSR direction: offsets start at 0, never decrease, end at m; targets are vertices.
+static bool validCsr(const int64_t* offsets, const int32_t* targets, int64_t n, int64_t m) {
+    if (offsets[0] != 0 || offsets[n] != m) {
+        return false;
+    }
+    for (int64_t i = 0; i < n; ++i) {
+        if (offsets[i + 1] < offsets[i]) {
+            return false;
+        }
+    }
+    for (int64_t i = 0; i < m; ++i) {
+        if (targets[i] < 0 || targets[i] >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readGraphFileLayout(int fd, GraphFileLayout& layout, string& error) {
+    struct stat st;
+    GraphFileHeader header;
+    if (fstat(fd, &st) < 0 || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        memcmp(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        error = "not a graph file";
+        return false;
+    }
+    if (header.version != GRAPH_FILE_VERSION) {
+        error = "unsupported graph file version " + to_string(header.version);
+        return false;
+    }
+    int64_t n = header.n;
+    int64_t m = header.m;
+    bool hasIds = header.flags & GRAPH_FILE_SCC_IDS;
+    if (n < 0 || n > INT32_MAX || m < 0 || m > INT32_MAX) {
+        error = "damaged graph file";
+        return false;
+    }
+    long offsetsBytes = (n + 1) * sizeof(int64_t);
+    long targetsBytes = aligned(m * sizeof(int32_t));
+    layout.n = static_cast<int>(n);
+    layout.m = m;
+    layout.offsetsAt = sizeof(GraphFileHeader);
+    layout.targetsAt = layout.offsetsAt + offsetsBytes;
+    layout.reverseOffsetsAt = layout.targetsAt + targetsBytes;
+    layout.reverseTargetsAt = layout.reverseOffsetsAt + offsetsBytes;
+    layout.componentIdsAt = hasIds ? layout.reverseTargetsAt + targetsBytes : -1;
+    if (st.st_size != layout.reverseTargetsAt + targetsBytes + (hasIds ? n * static_cast<long>(sizeof(int32_t)) : 0)) {
+        error = "truncated or damaged graph file";
+        return false;
+    }
+    return true;
+}
+
+bool MappedGraphFile::open(const string& path, string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    GraphFileLayout layout;
+    if (!readGraphFileLayout(fd, layout, error)) {
+        error = path + ": " + error;
+        close(fd);
+        return false;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    size = st.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    madvise(data, size, MADV_SEQUENTIAL); // Read front to back, once
+
+    const char* base = static_cast<const char*>(data);
+    int64_t n = layout.n;
+    m = layout.m;
+    csr.n = layout.n;
+    csr.offsets = reinterpret_cast<const int64_t*>(base + layout.offsetsAt);
+    csr.targets = reinterpret_cast<const int32_t*>(base + layout.targetsAt);
+    csr.reverseOffsets = reinterpret_cast<const int64_t*>(base + layout.reverseOffsetsAt);
+    csr.reverseTargets = reinterpret_cast<const int32_t*>(base + layout.reverseTargetsAt);
+    csr.componentIds = layout.componentIdsAt >= 0 ? reinterpret_cast<const int32_t*>(base + layout.componentIdsAt) : nullptr;
+
+    bool valid = validCsr(csr.offsets, csr.targets, n, m) && validCsr(csr.reverseOffsets, csr.reverseTargets, n, m);
+    for (int64_t i = 0; valid && csr.componentIds && i < n; ++i) {
+        valid = csr.componentIds[i] >= 0 && csr.componentIds[i] < n;
+    }
+    if (!valid) {
+        error = path + ": damaged graph file";
+        return false;
+    }
+    return true;
+}
+
+vector<pair<int, int>> MappedGraphFile::edges() const {
+    vector<pair<int, int>> edges;
+    edges.reserve(m);
+    for (int i = 0; i < csr.n; ++i) {
+        for (int64_t j = csr.offsets[i]; j < csr.offsets[i + 1]; ++j) {
+            edges.push_back({i + 1, csr.targets[j] + 1});
+        }
+    }
+    return edges;
+}
@@ -0,0 +1,83 @@
+#ifndef GRAPH_FILE_HPP
+#define GRAPH_FILE_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include "kosaraju_vector_list.hpp"
+
+/*
+Binary graph snapshot files, written by SAVE and mapped by LOAD.
+
+The file is the graph in compressed sparse row form, laid out exactly as it is used in memory,
+so loading is an mmap() plus straight copies of each vertex's neighbor range - there is nothing
+to parse. All numbers are native-endian; every section starts 8-byte aligned.
+
+    header          magic "KSCSR\0\0\0", uint32 version, uint32 flags, int64 n, int64 m
+    offsets         int64[n + 1]   out-neighbors of v: targets[offsets[v] .. offsets[v + 1])
+    targets         int32[m]       (0-based vertices)
+    reverseOffsets  int64[n + 1]   in-neighbors, as above
+    reverseTargets  int32[m]
+    componentIds    int32[n]       SCC id of each vertex, present if flags has GRAPH_FILE_SCC_IDS
+*/
+
+/// @brief Flag of a graph file storing the SCC id of every vertex.
+const unsigned GRAPH_FILE_SCC_IDS = 1;
+
+/// @brief Writes a graph file (through a temporary file, so a reader never sees half of one).
+/// @param path Path of the file.
+/// @param snapshot The graph.
+/// @param componentIds SCC id of each vertex (consistent with snapshot), or nullptr to omit them.
+/// @param error Set to the reason on failure.
+/// @return true on success.
+bool saveGraphFile(const std::string& path, const GraphSnapshot& snapshot, const std::vector<int>* componentIds, std::string& error);
+
+/// @brief Where the sections of a graph file are, for reading it without mapping it.
+struct GraphFileLayout {
+    int n;                  ///< Number of vertices.
+    long m;                 ///< Number of edges.
+    long offsetsAt;         ///< File offset of offsets.
+    long targetsAt;         ///< File offset of targets.
+    long reverseOffsetsAt;  ///< File offset of reverseOffsets.
+    long reverseTargetsAt;  ///< File offset of reverseTargets.
+    long componentIdsAt;    ///< File offset of componentIds, or -1 if absent.
+};
+
+/// @brief Reads and checks the header of a graph file.
+/// @param fd The open file.
+/// @param layout Set to where its sections are.
+/// @param error Set to the reason on failure.
+/// @return true if the header is valid and the file has the size it announces.
+bool readGraphFileLayout(int fd, GraphFileLayout& layout, std::string& error);
+
+/// @brief A graph file mapped into memory, unmapped on destruction.
+class MappedGraphFile {
+public:
+    MappedGraphFile() = default;
+    ~MappedGraphFile();
+    MappedGraphFile(const MappedGraphFile&) = delete;
+    MappedGraphFile& operator=(const MappedGraphFile&) = delete;
+
+    /// @brief Maps a graph file and checks that it is well-formed.
+    /// @param path Path of the file.
+    /// @param error Set to the reason on failure.
+    /// @return true on success.
+    bool open(const std::string& path, std::string& error);
+
+    /// @brief The mapped graph, valid while this object lives.
+    const CsrGraphView& view() const { return csr; }
+
+    /// @brief Number of edges in the graph.
+    long numEdges() const { return m; }
+
+    /// @brief Lists the edges, 1-based as clients send them.
+    std::vector<std::pair<int, int>> edges() const;
+
+private:
+    void* data = nullptr;  ///< Start of the mapping.
+    size_t size = 0;       ///< Length of the mapping.
+    long m = 0;            ///< Number of edges.
+    CsrGraphView csr = {}; ///< Pointers into the mapping.
+};
+
+#endif // GRAPH_FILE_HPP
@@ -0,0 +1,390 @@
+#include "graph_wal.hpp"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const long CHECKPOINT_BYTES = 64L << 20;              // Segment size after which a checkpoint pays off
+static const chrono::milliseconds SYNC_INTERVAL(2);          // How long the sync thread lets a group build up
+static const uint32_t CHECKPOINT_MAGIC = 0x504b4353;         // "SCKP"
+static const uint32_t CHECKPOINT_VERSION = 1;
+
+// Record types. A record is {type, words} + words 32-bit values + checksum of all of it.
+static const uint32_t RECORD_GRAPH = 1;       // n, m, then m (u, v) pairs
+static const uint32_t RECORD_ADD_EDGE = 2;    // u, v
+static const uint32_t RECORD_REMOVE_EDGE = 3; // u, v
+
+static_assert(sizeof(pair<int, int>) == 2 * sizeof(int32_t), "edges are read and written as int32 pairs");
+
+/// Directory holding the checkpoint and the segments
+static string logDir;
+/// Segment being appended to (-1 while logging is off)
+static int logFd = -1;
+/// Number of that segment
+static long logSegment = 0;
+/// Serializes writing and flushing segments; protects logFd and logSegment
+static mutex syncMutex;
+/// Protects buffer
+static mutex bufferMutex;
+/// Wakes the sync thread when buffer stops being empty
+static condition_variable bufferCond;
+/// Records logged but not yet written to the segment
+static string buffer;
+/// Bytes logged to the current segment
+static atomic<long> segmentBytes{0};
+/// Set while logFd is open, readable without syncMutex
+static atomic<bool> logging{false};
+/// Set between beginGraphCheckpoint() and the end of writeGraphCheckpoint()
+static atomic<bool> checkpointing{false};
+
+// FNV-1a, enough to tell a torn or garbled record from a complete one.
+static uint32_t checksum(uint32_t hash, const void* data, size_t len) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+static const uint32_t CHECKSUM_SEED = 2166136261u;
+
+static string segmentPath(long segment) {
+    return logDir + "/wal." + to_string(segment);
+}
+
+// Segment numbers present in the log directory, in increasing order.
+static vector<long> listSegments() {
+    vector<long> segments;
+    DIR* dir = opendir(logDir.c_str());
+    if (!dir) {
+        return segments;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        char* end = nullptr;
+        if (strncmp(entry->d_name, "wal.", 4) == 0) {
+            long segment = strtol(entry->d_name + 4, &end, 10);
+            if (end != entry->d_name + 4 && *end == '\0') {
+                segments.push_back(segment);
+            }
+        }
+    }
+    closedir(dir);
+    sort(segments.begin(), segments.end());
+    return segments;
+}
+
+// Makes creating, renaming and deleting files in the log directory durable.
+static void syncDirectory() {
+    int fd = open(logDir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+static bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+static int openSegment(long segment) {
+    int fd = open(segmentPath(segment).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        cerr << "Cannot open graph log segment " << segmentPath(segment) << ": " << strerror(errno) << endl;
+    }
+    return fd;
+}
+
+// Appends one record to buffer. Caller holds bufferMutex.
+static void appendRecord(uint32_t type, const int32_t* words, uint32_t count) {
+    uint32_t header[2] = {type, count};
+    uint32_t hash = checksum(checksum(CHECKSUM_SEED, header, sizeof(header)), words, count * sizeof(int32_t));
+    buffer.append(reinterpret_cast<const char*>(header), sizeof(header));
+    buffer.append(reinterpret_cast<const char*>(words), count * sizeof(int32_t));
+    buffer.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    segmentBytes.fetch_add(sizeof(header) + count * sizeof(int32_t) + sizeof(hash), memory_order_relaxed);
+    if (buffer.size() == sizeof(header) + count * sizeof(int32_t) + sizeof(hash)) {
+        bufferCond.notify_one(); // First record of a group
+    }
+}
+
+// Result of reading records from a file.
+enum ReplayResult { REPLAY_END, REPLAY_TORN };
+
+// Replays records until the end of the file or the first incomplete or damaged one.
+// @param offset Set to the end of the last good record.
+static ReplayResult replayRecords(FILE* file, long& offset, long& records, const LoggedGraphHandler& onGraph, const LoggedEdgeHandler& onEdge) {
+    offset = ftell(file);
+    while (true) {
+        uint32_t header[2];
+        size_t got = fread(header, 1, sizeof(header), file);
+        if (got == 0 && feof(file)) {
+            return REPLAY_END;
+        }
+        if (got != sizeof(header)) {
+            return REPLAY_TORN;
+        }
+        uint32_t hash = checksum(CHECKSUM_SEED, header, sizeof(header));
+        uint32_t stored;
+        if (header[0] == RECORD_GRAPH && header[1] >= 2) {
+            int32_t counts[2];
+            if (fread(counts, sizeof(int32_t), 2, file) != 2 || counts[1] < 0 || header[1] != 2 + 2 * static_cast<uint32_t>(counts[1])) {
+                return REPLAY_TORN;
+            }
+            vector<pair<int, int>> edges(counts[1]);
+            if (fread(edges.data(), sizeof(pair<int, int>), edges.size(), file) != edges.size() || fread(&stored, sizeof(stored), 1, file) != 1) {
+                return REPLAY_TORN;
+            }
+            hash = checksum(checksum(hash, counts, sizeof(counts)), edges.data(), edges.size() * sizeof(pair<int, int>));
+            if (hash != stored) {
+                return REPLAY_TORN;
+            }
+            onGraph(counts[0], edges);
+        } else if ((header[0] == RECORD_ADD_EDGE || header[0] == RECORD_REMOVE_EDGE) && header[1] == 2) {
+            int32_t edge[2];
+            if (fread(edge, sizeof(int32_t), 2, file) != 2 || fread(&stored, sizeof(stored), 1, file) != 1) {
+                return REPLAY_TORN;
+            }
+            if (checksum(hash, edge, sizeof(edge)) != stored) {
+                return REPLAY_TORN;
+            }
+            onEdge(edge[0], edge[1], header[0] == RECORD_ADD_EDGE);
+        } else {
+            return REPLAY_TORN;
+        }
+        records++;
+        offset = ftell(file);
+    }
+}
+
+// Sync thread: group-commits whatever the mutation paths logged.
+static void syncLoop() {
+    while (true) {
+        {
+            unique_lock<mutex> lock(bufferMutex);
+            bufferCond.wait(lock, []() { return !buffer.empty(); });
+        }
+        this_thread::sleep_for(SYNC_INTERVAL); // Let a group build up
+        syncGraphLog();
+    }
+}
+
+bool recoverGraphLog(const string& dir, LoggedGraphHandler onGraph, LoggedEdgeHandler onEdge) {
+    if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) {
+        cerr << "Cannot create graph log directory " << dir << ": " << strerror(errno) << endl;
+        return false;
+    }
+    logDir = dir;
+    long records = 0;
+    long offset = 0;
+
+    // The checkpoint: the graph as of the start of segment firstSegment
+    long firstSegment = 0;
+    if (FILE* file = fopen((logDir + "/checkpoint").c_str(), "rb")) {
+        uint32_t header[2];
+        int64_t segment;
+        if (fread(header, sizeof(header), 1, file) != 1 || header[0] != CHECKPOINT_MAGIC || header[1] != CHECKPOINT_VERSION ||
+            fread(&segment, sizeof(segment), 1, file) != 1 || replayRecords(file, offset, records, onGraph, onEdge) != REPLAY_END) {
+            cerr << "Graph log checkpoint in " << dir << " is damaged, not using the log" << endl;
+            fclose(file);
+            return false;
+        }
+        fclose(file);
+        firstSegment = segment;
+    }
+
+    // The segments after it, in order, up to the first torn record
+    vector<long> segments = listSegments();
+    bool torn = false;
+    int replayed = 0;
+    for (long segment : segments) {
+        string path = segmentPath(segment);
+        if (segment < firstSegment || torn) { // Covered by the checkpoint, or after a gap
+            if (torn) {
+                cerr << "Dropping graph log segment " << path << " after a torn record" << endl;
+            }
+            unlink(path.c_str());
+            continue;
+        }
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            cerr << "Cannot read graph log segment " << path << ": " << strerror(errno) << endl;
+            return false;
+        }
+        if (replayRecords(file, offset, records, onGraph, onEdge) == REPLAY_TORN) {
+            torn = true;
+            if (truncate(path.c_str(), offset) < 0) { // Cut the partial record off
+                cerr << "Cannot truncate graph log segment " << path << ": " << strerror(errno) << endl;
+            }
+        }
+        fclose(file);
+        replayed++;
+    }
+    if (records > 0) {
+        cout << "Recovered " << records << " graph log records from " << dir << " (" << replayed << " segments)" << endl;
+    }
+
+    // Continue in a fresh segment
+    logSegment = segments.empty() ? firstSegment : max(firstSegment, segments.back() + 1);
+    logFd = openSegment(logSegment);
+    if (logFd < 0) {
+        return false;
+    }
+    syncDirectory();
+    logging = true;
+    thread(syncLoop).detach();
+    return true;
+}
+
+bool graphLogEnabled() {
+    return logging.load(memory_order_relaxed);
+}
+
+void logNewGraph(int n, const vector<pair<int, int>>& edges) {
+    if (!logging.load(memory_order_relaxed)) {
+        return;
+    }
+    vector<int32_t> words;
+    words.reserve(2 + 2 * edges.size());
+    words.push_back(n);
+    words.push_back(static_cast<int32_t>(edges.size()));
+    for (const auto& edge : edges) {
+        words.push_back(edge.first);
+        words.push_back(edge.second);
+    }
+    lock_guard<mutex> lock(bufferMutex);
+    appendRecord(RECORD_GRAPH, words.data(), static_cast<uint32_t>(words.size()));
+}
+
+void logEdgeUpdate(int u, int v, bool add) {
+    if (!logging.load(memory_order_relaxed)) {
+        return;
+    }
+    int32_t edge[2] = {u, v};
+    lock_guard<mutex> lock(bufferMutex);
+    appendRecord(add ? RECORD_ADD_EDGE : RECORD_REMOVE_EDGE, edge, 2);
+}
+
+void syncGraphLog() {
+    lock_guard<mutex> sync(syncMutex);
+    string pending;
+    {
+        lock_guard<mutex> lock(bufferMutex);
+        pending.swap(buffer);
+    }
+    if (logFd < 0 || pending.empty()) {
+        return; // Whoever took the last group has flushed it: we held syncMutex after them
+    }
+    if (!writeAll(logFd, pending.data(), pending.size()) || fdatasync(logFd) < 0) {
+        cerr << "Error writing graph log: " << strerror(errno) << endl;
+    }
+}
+
+bool graphLogNeedsCheckpoint() {
+    return logging.load(memory_order_relaxed) && segmentBytes.load(memory_order_relaxed) >= CHECKPOINT_BYTES && !checkpointing.load();
+}
+
+long beginGraphCheckpoint() {
+    if (!logging.load(memory_order_relaxed) || checkpointing.exchange(true)) {
+        return -1;
+    }
+    lock_guard<mutex> sync(syncMutex);
+    string pending;
+    {
+        lock_guard<mutex> lock(bufferMutex);
+        pending.swap(buffer);
+    }
+    // The old segment must be complete on disk before anything reaches the new one:
+    // if the checkpoint never gets written, recovery replays both
+    if (!writeAll(logFd, pending.data(), pending.size()) || fdatasync(logFd) < 0) {
+        cerr << "Error writing graph log: " << strerror(errno) << endl;
+    }
+    close(logFd);
+    logSegment++;
+    logFd = openSegment(logSegment);
+    segmentBytes.store(0, memory_order_relaxed);
+    if (logFd < 0) {
+        logging = false; // Keep serving without the log
+        checkpointing = false;
+        return -1;
+    }
+    syncDirectory();
+    return logSegment;
+}
+
+void writeGraphCheckpoint(long segment, const GraphSnapshot* snapshot) {
+    string path = logDir + "/checkpoint";
+    string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        cerr << "Cannot write graph checkpoint " << tmpPath << ": " << strerror(errno) << endl;
+        checkpointing = false;
+        return;
+    }
+    vector<char> fileBuffer(1 << 20);
+    setvbuf(file, fileBuffer.data(), _IOFBF, fileBuffer.size());
+
+    uint32_t header[2] = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION};
+    int64_t first = segment;
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(&first, sizeof(first), 1, file);
+    if (snapshot) { // One graph record, streamed from the snapshot
+        int n = snapshot->getNumVertices();
+        long m = 0;
+        for (int i = 0; i < n; ++i) {
+            m += snapshot->neighbors(i).size();
+        }
+        uint32_t recordHeader[2] = {RECORD_GRAPH, static_cast<uint32_t>(2 + 2 * m)};
+        int32_t counts[2] = {n, static_cast<int32_t>(m)};
+        uint32_t hash = checksum(checksum(CHECKSUM_SEED, recordHeader, sizeof(recordHeader)), counts, sizeof(counts));
+        fwrite(recordHeader, sizeof(recordHeader), 1, file);
+        fwrite(counts, sizeof(counts), 1, file);
+        for (int i = 0; i < n; ++i) {
+            for (int neighbor : snapshot->neighbors(i)) {
+                int32_t edge[2] = {i + 1, neighbor + 1};
+                hash = checksum(hash, edge, sizeof(edge));
+                fwrite(edge, sizeof(edge), 1, file);
+            }
+        }
+        fwrite(&hash, sizeof(hash), 1, file);
+    }
+    bool ok = fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) < 0) {
+        cerr << "Error writing graph checkpoint " << tmpPath << ": " << strerror(errno) << endl;
+        unlink(tmpPath.c_str());
+        checkpointing = false;
+        return;
+    }
+    syncDirectory();
+
+    for (long old : listSegments()) { // Everything before segment is in the checkpoint now
+        if (old < segment) {
+            unlink(segmentPath(old).c_str());
+        }
+    }
+    checkpointing = false;
+    cout << "Graph log checkpoint written" << (snapshot ? " with " + to_string(snapshot->getNumVertices()) + " vertices" : string()) << endl;
+}
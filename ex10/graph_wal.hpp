@@ -0,0 +1,74 @@
+#ifndef GRAPH_WAL_HPP
+#define GRAPH_WAL_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include "kosaraju_vector_list.hpp"
+
+/*
+Write-ahead log of the served graph.
+
+Every mutation applied to the graph (NewGraph, NewEdge, RemoveEdge) is appended to an in-memory
+buffer under graphMutex, so the log has exactly the order the graph saw. A sync thread writes
+the buffer out and fdatasync()s it every few milliseconds: one disk flush commits a whole
+group of updates. Once a log segment grows large, the server takes a snapshot, starts a new
+segment and writes the snapshot as a checkpoint; the segments it covers are then deleted.
+
+On startup the checkpoint is loaded and the segments after it are replayed in order, so a
+restart costs one sequential read of the checkpoint plus the recent tail. A torn record at
+the end of the log (the server died mid-write) ends the replay and is cut off.
+
+Files in the log directory:
+    checkpoint   the graph as of the start of segment <first segment>
+    wal.<n>      segments, replayed in increasing n
+*/
+
+/// @brief Called during recovery for a logged NewGraph.
+typedef std::function<void(int n, const std::vector<std::pair<int, int>>& edges)> LoggedGraphHandler;
+/// @brief Called during recovery for a logged NewEdge (add) or RemoveEdge (!add).
+typedef std::function<void(int u, int v, bool add)> LoggedEdgeHandler;
+
+/// @brief Replays the log in a directory and starts logging to it.
+/// Must be called once, before any other function here; until then logging is off.
+/// @param dir The log directory (created if missing).
+/// @param onGraph Called for every logged graph, in order.
+/// @param onEdge Called for every logged edge update, in order.
+/// @return true if the log is in use, false if the directory cannot be used.
+bool recoverGraphLog(const std::string& dir, LoggedGraphHandler onGraph, LoggedEdgeHandler onEdge);
+
+/// @brief Returns true if mutations are being logged.
+bool graphLogEnabled();
+
+/// @brief Logs a new graph. Must be called with graphMutex held.
+/// @param n Number of vertices.
+/// @param edges Edges of the graph (1-based).
+void logNewGraph(int n, const std::vector<std::pair<int, int>>& edges);
+
+/// @brief Logs an applied edge update. Must be called with graphMutex held.
+/// @param u Start vertex (1-based).
+/// @param v End vertex (1-based).
+/// @param add true for NewEdge, false for RemoveEdge.
+void logEdgeUpdate(int u, int v, bool add);
+
+/// @brief Writes out and flushes to disk everything logged so far.
+/// The sync thread does this on its own; call it to make one update durable right away.
+/// Must be called without graphMutex.
+void syncGraphLog();
+
+/// @brief Returns true if the current segment has grown enough to be worth a checkpoint.
+bool graphLogNeedsCheckpoint();
+
+/// @brief Flushes the current segment and starts a new one. Must be called with graphMutex held,
+/// together with taking the snapshot passed to writeGraphCheckpoint().
+/// @return The number of the new segment, or -1 if logging is off or a checkpoint is underway.
+long beginGraphCheckpoint();
+
+/// @brief Writes a checkpoint and deletes the segments it makes redundant.
+/// Must be called without graphMutex, after a successful beginGraphCheckpoint().
+/// @param segment The segment number beginGraphCheckpoint() returned.
+/// @param snapshot The graph when the segment was started, or nullptr if there was none.
+void writeGraphCheckpoint(long segment, const GraphSnapshot* snapshot);
+
+#endif // GRAPH_WAL_HPP
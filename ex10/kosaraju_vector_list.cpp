@@ -1,121 +1,441 @@
 #include "kosaraju_vector_list.hpp"
 #include <iostream>
+#include <atomic>
 #include <algorithm>
 
 using namespace std;
 
-KosarajuVectorList::KosarajuVectorList(int n, const vector<pair<int, int>>& edges) : n(n) {
-    graph.resize(n);
-    transposedGraph.resize(n);
-    visited.resize(n, false);
-    for (const auto& edge : edges) {
-        graph[edge.first - 1].push_back(edge.second - 1); // Adjust for 0-based indexing
-        transposedGraph[edge.second - 1].push_back(edge.first - 1); // Create transposed graph
+ChunkedAdjacency::ChunkedAdjacency(int n) : table(make_shared<Table>()) {
+    for (int i = 0; i < n; i += CHUNK_VERTICES) {
+        table->push_back(make_shared<Chunk>());
     }
 }
 
-void KosarajuVectorList::findSCCs() {
-    sccs.clear(); // Clear the SCCs vector before finding SCCs
-    fill(visited.begin(), visited.end(), false); // Reset the visited vector
-    while (!finishStack.empty()) {
-        finishStack.pop(); // Clear the finish stack
+vector<int>& ChunkedAdjacency::modify(int v) {
+    // use_count() == 1 means no snapshot can reach it any more; the acquire fence orders our
+    // writes after the snapshot's last reads (which precede its release of the reference)
+    if (table.use_count() > 1) {
+        table = make_shared<Table>(*table); // Copies the chunk pointers only
+    } else {
+        atomic_thread_fence(memory_order_acquire);
+    }
+    shared_ptr<Chunk>& chunk = (*table)[v / CHUNK_VERTICES];
+    if (chunk.use_count() > 1) {
+        chunk = make_shared<Chunk>(*chunk); // Copies the lists of this chunk's vertices only
+    } else {
+        atomic_thread_fence(memory_order_acquire);
+    }
+    return chunk->lists[v % CHUNK_VERTICES];
+}
+
+vector<vector<int>> GraphSnapshot::findSCCs() const {
+    return runKosaraju(nullptr);
+}
+
+Condensation GraphSnapshot::condense() const {
+    Condensation condensation;
+    condensation.sccs = runKosaraju(&condensation.componentOf);
+    const vector<int>& componentOf = condensation.componentOf;
+    int components = condensation.numComponents();
+
+    // Edges between components, each once: lastSource remembers which component last added a target
+    vector<int> lastSource(components, -1);
+    condensation.offsets.reserve(components + 1);
+    condensation.offsets.push_back(0);
+    for (int c = 0; c < components; ++c) {
+        for (int node : condensation.sccs[c]) {
+            for (int neighbor : graph[node]) {
+                int target = componentOf[neighbor];
+                if (target != c && lastSource[target] != c) {
+                    lastSource[target] = c;
+                    condensation.targets.push_back(target);
+                }
+            }
+        }
+        condensation.offsets.push_back(static_cast<int>(condensation.targets.size()));
     }
+    return condensation;
+}
+
+void Condensation::print(ostream& out) const {
+    out << "\nCondensation DAG: " << numComponents() << " components, " << numEdges() << " edges (components in topological order):" << endl;
+    for (int c = 0; c < numComponents(); ++c) {
+        out << "Component " << c + 1 << ": ";
+        for (int node : sccs[c]) {
+            out << node + 1 << " "; // Convert back to 1-based index for output
+        }
+        out << endl;
+    }
+    out << "Edges:" << endl;
+    for (int c = 0; c < numComponents(); ++c) {
+        for (int i = offsets[c]; i < offsets[c + 1]; ++i) {
+            out << c + 1 << " -> " << targets[i] + 1 << endl;
+        }
+    }
+}
+
+vector<vector<int>> GraphSnapshot::runKosaraju(vector<int>* componentOf) const {
+    vector<vector<int>> sccs;
+    if (componentOf) {
+        componentOf->assign(n, -1);
+    }
+    vector<bool> visited(n, false);
+    vector<int> finishOrder;
+    finishOrder.reserve(n);
+    vector<pair<int, size_t>> stack; // (node, next neighbor): iterative, so deep graphs cannot overflow
 
-    // First Pass
+    // First Pass: vertices in order of their finishing times
     for (int i = 0; i < n; ++i) {
-        if (!visited[i]) {
-            dfsFirstPass(i); // Perform DFS to fill the finish stack
+        if (visited[i]) {
+            continue;
+        }
+        visited[i] = true;
+        stack.push_back({i, 0});
+        while (!stack.empty()) {
+            int node = stack.back().first;
+            if (stack.back().second == graph[node].size()) {
+                finishOrder.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+            int neighbor = graph[node][stack.back().second++];
+            if (!visited[neighbor]) {
+                visited[neighbor] = true;
+                stack.push_back({neighbor, 0});
+            }
         }
     }
 
-    // Second Pass
-    fill(visited.begin(), visited.end(), false); // Reset the visited vector
-    while (!finishStack.empty()) {
-        int node = finishStack.top();
-        finishStack.pop();
-        if (!visited[node]) {
-            vector<int> scc;
-            dfsSecondPass(node, scc); // Perform DFS to find SCCs
-            sccs.push_back(scc);
+    // Second Pass: on the transposed graph, latest finishing vertex first
+    fill(visited.begin(), visited.end(), false);
+    for (auto it = finishOrder.rbegin(); it != finishOrder.rend(); ++it) {
+        if (visited[*it]) {
+            continue;
         }
+        vector<int> scc(1, *it);
+        visited[*it] = true;
+        if (componentOf) {
+            (*componentOf)[*it] = static_cast<int>(sccs.size());
+        }
+        stack.push_back({*it, 0});
+        while (!stack.empty()) {
+            int node = stack.back().first;
+            if (stack.back().second == transposedGraph[node].size()) {
+                stack.pop_back();
+                continue;
+            }
+            int neighbor = transposedGraph[node][stack.back().second++];
+            if (!visited[neighbor]) {
+                visited[neighbor] = true;
+                scc.push_back(neighbor);
+                if (componentOf) {
+                    (*componentOf)[neighbor] = static_cast<int>(sccs.size());
+                }
+                stack.push_back({neighbor, 0});
+            }
+        }
+        sccs.push_back(scc);
     }
+    return sccs;
 }
 
-void KosarajuVectorList::printSCCs() const {
-    cout << "\nKosaraju Vector List algorithm: Strongly Connected Components (SCCs):" << endl;
+void GraphSnapshot::printSCCs(const vector<vector<int>>& sccs, ostream& out) {
+    out << "\nKosaraju Vector List algorithm: Strongly Connected Components (SCCs):" << endl;
     int sccCount = 1;
     for (const auto& scc : sccs) {
-        cout << "SCC " << sccCount++ << ": ";
+        out << "SCC " << sccCount++ << ": ";
         for (int node : scc) {
-            cout << node + 1 << " "; // Convert back to 1-based index for output
+            out << node + 1 << " "; // Convert back to 1-based index for output
         }
-        cout << endl << "----------------" << endl;
+        out << endl << "----------------" << endl;
     }
 }
 
-void KosarajuVectorList::printGraph() const {
-    cout << "\nCurrent Graph (Adjacency Matrix):" << endl;
-    cout << "    ";
+void GraphSnapshot::printGraph(ostream& out) const {
+    out << "\nCurrent Graph (Adjacency Matrix):" << endl;
+    out << "    ";
     for (int i = 0; i < n; ++i) {
-        cout << i + 1 << " ";
+        out << i + 1 << " ";
     }
-    cout << "\n   " << string(n * 2, '-') << endl;
+    out << "\n   " << string(n * 2, '-') << endl;
     for (int i = 0; i < n; ++i) {
-        cout << i + 1 << " | ";
+        out << i + 1 << " | ";
         for (int j = 0; j < n; ++j) {
             if (find(graph[i].begin(), graph[i].end(), j) != graph[i].end()) {
-                cout << "1 "; // Print 1 if there is an edge
+                out << "1 "; // Print 1 if there is an edge
             } else {
-                cout << "0 "; // Print 0 if there is no edge
+                out << "0 "; // Print 0 if there is no edge
             }
         }
-        cout << endl;
+        out << endl;
     }
 
-    cout << "\nEdges:" << endl;
+    out << "\nEdges:" << endl;
     for (int i = 0; i < n; ++i) {
         for (int neighbor : graph[i]) {
-            cout << i + 1 << " -> " << neighbor + 1 << endl; // Print all edges
+            out << i + 1 << " -> " << neighbor + 1 << endl; // Print all edges
         }
     }
 }
 
+KosarajuVectorList::KosarajuVectorList(int n, const vector<pair<int, int>>& edges) : n(n), graph(n), transposedGraph(n) {
+    visited.resize(n, false);
+    reaching.resize(n, false);
+    for (const auto& edge : edges) {
+        graph.modify(edge.first - 1).push_back(edge.second - 1); // Adjust for 0-based indexing
+        transposedGraph.modify(edge.second - 1).push_back(edge.first - 1); // Create transposed graph
+    }
+    seedComponents(nullptr);
+}
+
+KosarajuVectorList::KosarajuVectorList(const CsrGraphView& csr) : n(csr.n), graph(csr.n), transposedGraph(csr.n) {
+    visited.resize(n, false);
+    reaching.resize(n, false);
+    for (int i = 0; i < n; ++i) { // Straight copies of each vertex's range: no parsing, no push_back growth
+        graph.modify(i).assign(csr.targets + csr.offsets[i], csr.targets + csr.offsets[i + 1]);
+        transposedGraph.modify(i).assign(csr.reverseTargets + csr.reverseOffsets[i], csr.reverseTargets + csr.reverseOffsets[i + 1]);
+    }
+    seedComponents(csr.componentIds);
+}
+
+void KosarajuVectorList::seedComponents(const int32_t* ids) {
+    component.assign(n, 0);
+    componentSize.assign(n, 0);
+    sizeCount.assign(n + 1, 0);
+    if (ids) { // Known SCCs: only count them
+        vector<int> sizes(n, 0);
+        for (int i = 0; i < n; ++i) {
+            component[i] = ids[i];
+            sizes[ids[i]]++;
+        }
+        for (int id = n - 1; id >= 0; --id) {
+            if (sizes[id] > 0) {
+                setComponentSize(id, sizes[id]);
+            } else {
+                freeIds.push_back(id);
+            }
+        }
+        return;
+    }
+
+    // One full pass: start from a single id holding every vertex and let relabelComponent() split it
+    for (int id = n - 1; id > 0; --id) {
+        freeIds.push_back(id);
+    }
+    if (n > 0) {
+        setComponentSize(0, n);
+        vector<int> vertices(n);
+        for (int i = 0; i < n; ++i) {
+            vertices[i] = i;
+        }
+        relabelComponent(vertices);
+    }
+}
+
+void KosarajuVectorList::findSCCs() {
+    sccs = snapshot().findSCCs();
+}
+
+void KosarajuVectorList::printSCCs(ostream& out) const {
+    GraphSnapshot::printSCCs(sccs, out);
+}
+
+void KosarajuVectorList::printGraph(ostream& out) const {
+    snapshot().printGraph(out);
+}
+
 void KosarajuVectorList::addEdge(int u, int v) {
-    graph[u - 1].push_back(v - 1); // Add edge to the graph
-    transposedGraph[v - 1].push_back(u - 1); // Add edge to the transposed graph
+    graph.modify(u - 1).push_back(v - 1); // Add edge to the graph
+    transposedGraph.modify(v - 1).push_back(u - 1); // Add edge to the transposed graph
+    if (u != v) {
+        mergeComponents(u - 1, v - 1); // The edge may close a cycle through several SCCs
+    }
 }
 
 void KosarajuVectorList::removeEdge(int u, int v) {
-    graph[u - 1].erase(remove(graph[u - 1].begin(), graph[u - 1].end(), v - 1), graph[u - 1].end()); // Remove edge from the graph
-    transposedGraph[v - 1].erase(remove(transposedGraph[v - 1].begin(), transposedGraph[v - 1].end(), u - 1), transposedGraph[v - 1].end()); // Remove edge from the transposed graph
-}
+    if (find(graph[u - 1].begin(), graph[u - 1].end(), v - 1) == graph[u - 1].end()) {
+        return; // No such edge: leave the chunks shared
+    }
+    vector<int>& out = graph.modify(u - 1);
+    out.erase(remove(out.begin(), out.end(), v - 1), out.end()); // Remove edge from the graph
+    vector<int>& in = transposedGraph.modify(v - 1);
+    in.erase(remove(in.begin(), in.end(), u - 1), in.end()); // Remove edge from the transposed graph
+    if (u == v || component[u - 1] != component[v - 1]) {
+        return; // No edge inside an SCC was removed: no SCC can split
+    }
 
-void KosarajuVectorList::dfsFirstPass(int node) {
-    visited[node] = true; // Mark the node as visited
-    for (int neighbor : graph[node]) {
-        if (!visited[neighbor]) {
-            dfsFirstPass(neighbor); // Recursively visit all neighbors
+    // Every vertex of the SCC still reaches u (a path through u -> v passes u first),
+    // so walking the transposed edges from u inside the SCC finds all of its vertices
+    int id = component[u - 1];
+    vector<int> vertices(1, u - 1);
+    visited[u - 1] = true;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        for (int neighbor : transposedGraph[vertices[i]]) {
+            if (!visited[neighbor] && component[neighbor] == id) {
+                visited[neighbor] = true;
+                vertices.push_back(neighbor);
+            }
         }
     }
-    finishStack.push(node); // Push the node to the finish stack after visiting all neighbors
+    relabelComponent(vertices);
 }
 
-void KosarajuVectorList::dfsSecondPass(int node, vector<int>& scc) {
-    visited[node] = true; // Mark the node as visited
-    scc.push_back(node); // Add the node to the current SCC
-    for (int neighbor : transposedGraph[node]) {
-        if (!visited[neighbor]) {
-            dfsSecondPass(neighbor, scc); // Recursively visit all neighbors in the transposed graph
+void KosarajuVectorList::setComponentSize(int id, int size) {
+    int old = componentSize[id];
+    if (old == size) {
+        return;
+    }
+    if (old > 0) {
+        sizeCount[old]--;
+    } else {
+        componentCount++;
+    }
+    if (size > 0) {
+        sizeCount[size]++;
+    } else {
+        componentCount--;
+        freeIds.push_back(id); // Reused by the next split
+    }
+    componentSize[id] = size;
+    largestSize = max(largestSize, size);
+    while (largestSize > 0 && sizeCount[largestSize] == 0) {
+        largestSize--; // Only moves down after a split, by at most the split's size
+    }
+}
+
+void KosarajuVectorList::relabelComponent(const vector<int>& vertices) {
+    int id = component[vertices[0]];
+
+    // First pass: finishing order, iteratively so large SCCs cannot overflow the stack
+    for (int node : vertices) {
+        visited[node] = false;
+    }
+    vector<int> order;
+    order.reserve(vertices.size());
+    vector<pair<int, size_t>> stack;
+    for (int start : vertices) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = true;
+        stack.push_back({start, 0});
+        while (!stack.empty()) {
+            int node = stack.back().first;
+            if (stack.back().second == graph[node].size()) {
+                order.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+            int neighbor = graph[node][stack.back().second++];
+            if (!visited[neighbor] && component[neighbor] == id) {
+                visited[neighbor] = true;
+                stack.push_back({neighbor, 0});
+            }
+        }
+    }
+
+    // Second pass on the transposed edges, in reverse finishing order: each walk is one SCC
+    for (int node : vertices) {
+        visited[node] = false;
+    }
+    setComponentSize(id, 0); // Release the id; the first new SCC usually gets it back
+    vector<int> members;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        if (visited[*it]) {
+            continue;
+        }
+        int newId = freeIds.back();
+        freeIds.pop_back();
+        members.assign(1, *it);
+        visited[*it] = true;
+        for (size_t i = 0; i < members.size(); ++i) {
+            for (int neighbor : transposedGraph[members[i]]) {
+                if (!visited[neighbor] && component[neighbor] == id) {
+                    visited[neighbor] = true;
+                    members.push_back(neighbor);
+                }
+            }
+            component[members[i]] = newId; // Only after its neighbors: newId may equal id
         }
+        setComponentSize(newId, static_cast<int>(members.size()));
+    }
+    for (int node : vertices) {
+        visited[node] = false;
     }
 }
 
-int KosarajuVectorList::largestSCCSize() const {
-    int maxSize = 0;
-    for (const auto& scc : sccs) {
-        if (scc.size() > maxSize) {
-            maxSize = scc.size();
+void KosarajuVectorList::mergeComponents(int u, int v) {
+    if (component[u] == component[v]) {
+        return;
+    }
+
+    // The new cycle is what v reaches and what reaches u. Search forwards from v and backwards
+    // from u in turns, scanning about as many edges on each side, until one side has found
+    // everything it can: it then holds the whole cycle, for at most twice the smaller search.
+    vector<int> forward(1, v), backward(1, u);
+    visited[v] = true;
+    reaching[u] = true;
+    size_t forwardNext = 0, backwardNext = 0, forwardEdges = 0, backwardEdges = 0;
+    while (forwardNext < forward.size() && backwardNext < backward.size()) {
+        if (forwardEdges <= backwardEdges) {
+            int node = forward[forwardNext++];
+            forwardEdges += graph[node].size() + 1;
+            for (int neighbor : graph[node]) {
+                if (!visited[neighbor]) {
+                    visited[neighbor] = true;
+                    forward.push_back(neighbor);
+                }
+            }
+        } else {
+            int node = backward[backwardNext++];
+            backwardEdges += transposedGraph[node].size() + 1;
+            for (int neighbor : transposedGraph[node]) {
+                if (!reaching[neighbor]) {
+                    reaching[neighbor] = true;
+                    backward.push_back(neighbor);
+                }
+            }
+        }
+    }
+
+    // If the complete side contains the other end of the edge, walk from that end through the
+    // complete side only, unmarking vertices as they join the cycle: a vertex on a path to or
+    // from the cycle within that side is on the cycle itself
+    bool forwardComplete = forwardNext == forward.size();
+    vector<int> cycle;
+    if (forwardComplete ? visited[u] : reaching[v]) {
+        const ChunkedAdjacency& edges = forwardComplete ? transposedGraph : graph;
+        vector<bool>& inside = forwardComplete ? visited : reaching;
+        cycle.push_back(forwardComplete ? u : v);
+        inside[cycle[0]] = false;
+        for (size_t i = 0; i < cycle.size(); ++i) {
+            for (int neighbor : edges[cycle[i]]) {
+                if (inside[neighbor]) {
+                    inside[neighbor] = false;
+                    cycle.push_back(neighbor);
+                }
+            }
+        }
+    }
+    for (int node : forward) {
+        visited[node] = false;
+    }
+    for (int node : backward) {
+        reaching[node] = false;
+    }
+    if (cycle.empty()) {
+        return; // No path back from v to u: no new cycle
+    }
+
+    int target = component[u];
+    int added = 0;
+    for (int node : cycle) {
+        int old = component[node];
+        if (old != target) {
+            setComponentSize(old, componentSize[old] - 1);
+            component[node] = target;
+            added++;
         }
     }
-    return maxSize;
+    setComponentSize(target, componentSize[target] + added);
 }
@@ -2,13 +2,123 @@
 #define KOSARAJU_VECTOR_LIST_H
 
 #include <iostream>
-#include <list>
-#include <stack>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <algorithm>
 
 using namespace std;
 
+/// @brief Adjacency lists kept in fixed-size chunks that are shared copy-on-write.
+/// Copying is O(1): copies share every chunk until one of them modifies a vertex, which then
+/// copies the chunk table and the chunk holding that vertex, nothing else.
+class ChunkedAdjacency {
+public:
+    static const int CHUNK_VERTICES = 64; ///< Vertices per chunk.
+
+    /// @brief Creates empty lists for n vertices.
+    /// @param n Number of vertices.
+    explicit ChunkedAdjacency(int n = 0);
+
+    /// @brief Neighbors of a vertex (read-only, never copies).
+    /// @param v The vertex (0-based).
+    const vector<int>& operator[](int v) const { return (*table)[v / CHUNK_VERTICES]->lists[v % CHUNK_VERTICES]; }
+
+    /// @brief Neighbors of a vertex for modification; unshares its chunk first.
+    /// @param v The vertex (0-based).
+    vector<int>& modify(int v);
+
+private:
+    struct Chunk {
+        vector<int> lists[CHUNK_VERTICES]; ///< Neighbors of each vertex of the chunk.
+    };
+    typedef vector<shared_ptr<Chunk>> Table;
+
+    shared_ptr<Table> table; ///< Chunk pointers, shared between copies until one writes.
+};
+
+/// @brief The condensation DAG of a graph: every SCC contracted to a single vertex.
+/// Components are numbered in topological order, so every edge goes from a lower id to a higher one.
+struct Condensation {
+    vector<vector<int>> sccs; ///< Vertices of each component (0-based), as findSCCs() returns them.
+    vector<int> componentOf;  ///< Component of each vertex.
+    vector<int> offsets;      ///< Edges of component c: targets[offsets[c]] .. targets[offsets[c + 1] - 1].
+    vector<int> targets;      ///< Distinct successor components, grouped by component.
+
+    /// @brief Number of components.
+    int numComponents() const { return static_cast<int>(sccs.size()); }
+
+    /// @brief Number of vertices of the graph.
+    int numVertices() const { return static_cast<int>(componentOf.size()); }
+
+    /// @brief Number of distinct edges between components.
+    int numEdges() const { return static_cast<int>(targets.size()); }
+
+    /// @brief Prints the components and their edges (1-based, like the other outputs).
+    /// @param out Stream to print to.
+    void print(ostream& out = cout) const;
+};
+
+/// @brief Immutable view of a graph at one point in time.
+/// Taken in O(1) under the graph's lock and then used without it: later changes to the
+/// graph copy the chunks they touch instead of modifying what the snapshot sees.
+class GraphSnapshot {
+public:
+    /// @param n Number of vertices.
+    /// @param graph Adjacency lists (shared, not copied).
+    /// @param transposedGraph Adjacency lists of the transposed graph (shared, not copied).
+    GraphSnapshot(int n, const ChunkedAdjacency& graph, const ChunkedAdjacency& transposedGraph)
+        : n(n), graph(graph), transposedGraph(transposedGraph) {}
+
+    /// @brief Function to get the number of vertices in the graph.
+    int getNumVertices() const { return n; }
+
+    /// @brief Out-neighbors of a vertex.
+    /// @param v The vertex (0-based).
+    const vector<int>& neighbors(int v) const { return graph[v]; }
+
+    /// @brief In-neighbors of a vertex.
+    /// @param v The vertex (0-based).
+    const vector<int>& reverseNeighbors(int v) const { return transposedGraph[v]; }
+
+    /// @brief Finds the strongly connected components with Kosaraju's algorithm.
+    /// @return The SCCs, each a vector of 0-based vertices.
+    vector<vector<int>> findSCCs() const;
+
+    /// @brief Finds the SCCs and builds the condensation DAG from the same Kosaraju run.
+    /// @return The condensation, components in topological order.
+    Condensation condense() const;
+
+    /// @brief Function to print the graph.
+    /// @param out Stream to print to.
+    void printGraph(ostream& out = cout) const;
+
+    /// @brief Function to print strongly connected components (SCCs).
+    /// @param sccs The SCCs, as returned by findSCCs().
+    /// @param out Stream to print to.
+    static void printSCCs(const vector<vector<int>>& sccs, ostream& out = cout);
+
+private:
+    int n; ///< Number of vertices in the graph.
+    ChunkedAdjacency graph; ///< Adjacency lists of the graph.
+    ChunkedAdjacency transposedGraph; ///< Adjacency lists of the transposed graph.
+
+    /// @brief Kosaraju's algorithm. The SCCs come out in topological order of the condensation.
+    /// @param componentOf If not nullptr, set to the index of each vertex's SCC.
+    vector<vector<int>> runKosaraju(vector<int>* componentOf) const;
+};
+
+/// @brief A graph in compressed sparse row form, e.g. mapped from a snapshot file (not owned).
+/// The out-neighbors of v are targets[offsets[v]] .. targets[offsets[v + 1] - 1], all 0-based.
+struct CsrGraphView {
+    int n;                         ///< Number of vertices.
+    const int64_t* offsets;        ///< n + 1 offsets into targets.
+    const int32_t* targets;        ///< Out-neighbors, grouped by vertex.
+    const int64_t* reverseOffsets; ///< n + 1 offsets into reverseTargets.
+    const int32_t* reverseTargets; ///< In-neighbors, grouped by vertex.
+    const int32_t* componentIds;   ///< SCC id (< n) of each vertex, or nullptr to compute the SCCs.
+};
+
 /// @brief Class to represent a directed graph and find its strongly connected components using Kosaraju's algorithm.
 class KosarajuVectorList {
 public:
@@ -17,14 +127,25 @@ public:
     /// @param edges Vector of edges where each edge is represented as a pair of integers.
     KosarajuVectorList(int n, const vector<pair<int, int>>& edges);
 
+    /// @brief Constructor copying a graph in CSR form, e.g. a mapped snapshot file.
+    /// With SCC ids given they are taken as they are, skipping the pass that computes them.
+    /// @param csr The graph; must be valid (offsets non-decreasing, vertices and ids below n).
+    explicit KosarajuVectorList(const CsrGraphView& csr);
+
+    /// @brief Takes an O(1) snapshot that stays valid and unchanged while the graph is modified.
+    /// @return The snapshot.
+    GraphSnapshot snapshot() const { return GraphSnapshot(n, graph, transposedGraph); }
+
     /// @brief Function to find all strongly connected components (SCCs) of the graph.
     void findSCCs();
 
     /// @brief Function to print the strongly connected components (SCCs).
-    void printSCCs() const;
+    /// @param out Stream to print to.
+    void printSCCs(ostream& out = cout) const;
 
     /// @brief Function to print the graph.
-    void printGraph() const;
+    /// @param out Stream to print to.
+    void printGraph(ostream& out = cout) const;
 
     /// @brief Function to add an edge to the graph.
     /// @param u The start vertex of the edge.
@@ -45,25 +166,56 @@ public:
     vector<vector<int>> getSCCs() const { return sccs; }
 
     /// @brief Function to get the size of the largest SCC.
+    /// Kept up to date by every addEdge()/removeEdge(), so findSCCs() is not needed first.
     /// @return The size of the largest SCC.
-    int largestSCCSize() const;
+    int largestSCCSize() const { return largestSize; }
+
+    /// @brief Function to get the number of SCCs, kept up to date like largestSCCSize().
+    /// @return The number of SCCs.
+    int numComponents() const { return componentCount; }
+
+    /// @brief Function to get the SCC id of every vertex, kept up to date like largestSCCSize().
+    /// Vertices share an id exactly when they are in the same SCC; ids are below the vertex count.
+    /// @return The SCC id of each vertex (0-based).
+    const vector<int>& componentIds() const { return component; }
 
 private:
     int n; ///< Number of vertices in the graph.
-    vector<list<int>> graph; ///< Adjacency list representation of the graph.
-    vector<list<int>> transposedGraph; ///< Adjacency list of the transposed graph.
-    vector<bool> visited; ///< Vector to keep track of visited vertices.
-    stack<int> finishStack; ///< Stack to store the vertices in the order of their finishing times.
+    ChunkedAdjacency graph; ///< Adjacency list representation of the graph.
+    ChunkedAdjacency transposedGraph; ///< Adjacency list of the transposed graph.
+    vector<bool> visited; ///< Scratch marks of the incremental updates (all false between calls).
+    vector<bool> reaching; ///< Scratch marks of mergeComponents()'s backward search (all false between calls).
     vector<vector<int>> sccs; ///< Vector to store the strongly connected components (SCCs).
 
-    /// @brief Depth-first search (DFS) function for the first pass of Kosaraju's algorithm.
-    /// @param node The current node to visit.
-    void dfsFirstPass(int node);
+    // Incrementally maintained SCCs (independent of sccs, which only findSCCs() fills)
+    vector<int> component;     ///< Id of the SCC each vertex belongs to.
+    vector<int> componentSize; ///< Number of vertices per SCC id (0 for unused ids).
+    vector<int> freeIds;       ///< SCC ids not currently in use.
+    vector<int> sizeCount;     ///< Number of SCCs of each size.
+    int largestSize = 0;       ///< Size of the largest SCC.
+    int componentCount = 0;    ///< Number of SCCs.
+
+    /// @brief Sets up the incrementally maintained SCCs once the adjacency lists are filled.
+    /// @param ids SCC ids to take as they are, or nullptr to compute them.
+    void seedComponents(const int32_t* ids);
+
+    /// @brief Changes the recorded size of an SCC, keeping sizeCount and largestSize in step.
+    /// @param id The SCC id.
+    /// @param size The new size (0 releases the id).
+    void setComponentSize(int id, int size);
+
+    /// @brief Splits a set of vertices sharing one SCC id into its actual SCCs.
+    /// Only edges between vertices of the set are followed.
+    /// @param vertices The vertices of the SCC (all with the same id).
+    void relabelComponent(const vector<int>& vertices);
 
-    /// @brief Depth-first search (DFS) function for the second pass of Kosaraju's algorithm.
-    /// @param node The current node to visit.
-    /// @param scc The current strongly connected component (SCC) being formed.
-    void dfsSecondPass(int node, vector<int>& scc);
+    /// @brief Merges the SCCs that an edge u -> v closes a cycle through.
+    /// Searches forwards from v and backwards from u at once and stops when either search is
+    /// complete, so an insertion costs O(min(R, C)) with R the vertices and edges reachable from v
+    /// and C those reaching u. An edge into a large downstream region from a vertex with few
+    /// ancestors (or the reverse) stays cheap. The worst case, where both v reaches and u is
+    /// reached from most of the graph, is still O(V + E) per insertion.
+    void mergeComponents(int u, int v);
 };
 
 #endif // KOSARAJU_VECTOR_LIST_H
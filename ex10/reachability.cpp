@@ -0,0 +1,98 @@
+#include "reachability.hpp"
+#include <algorithm>
+#include <random>
+#include <utility>
+
+using namespace std;
+
+ReachabilityIndex::ReachabilityIndex(Condensation condensation) : dag(std::move(condensation)) {
+    int components = dag.numComponents();
+    mt19937 random(12345); // Fixed seed: the same graph always gets the same labels
+    vector<int> roots(components);
+    vector<int> children(dag.targets);
+    vector<bool> visited(components);
+    vector<pair<int, int>> stack; // (component, next child index): iterative, so deep DAGs cannot overflow
+
+    for (int label = 0; label < REACH_LABELS; ++label) {
+        // A different random order of the roots and of every component's children per label
+        for (int c = 0; c < components; ++c) {
+            roots[c] = c;
+            shuffle(children.begin() + dag.offsets[c], children.begin() + dag.offsets[c + 1], random);
+        }
+        shuffle(roots.begin(), roots.end(), random);
+        low[label].assign(components, 0);
+        post[label].assign(components, 0);
+        fill(visited.begin(), visited.end(), false);
+        int counter = 0;
+        for (int root : roots) {
+            if (visited[root]) {
+                continue;
+            }
+            visited[root] = true;
+            low[label][root] = components; // Lowered by the children, then by its own number
+            stack.push_back({root, dag.offsets[root]});
+            while (!stack.empty()) {
+                int c = stack.back().first;
+                if (stack.back().second == dag.offsets[c + 1]) {
+                    post[label][c] = counter++;
+                    low[label][c] = min(low[label][c], post[label][c]);
+                    stack.pop_back();
+                    if (!stack.empty()) {
+                        int parent = stack.back().first;
+                        low[label][parent] = min(low[label][parent], low[label][c]);
+                    }
+                    continue;
+                }
+                int child = children[stack.back().second++];
+                if (!visited[child]) {
+                    visited[child] = true;
+                    low[label][child] = components;
+                    stack.push_back({child, dag.offsets[child]});
+                } else {
+                    low[label][c] = min(low[label][c], low[label][child]); // Finished already: a DAG has no back edges
+                }
+            }
+        }
+    }
+}
+
+bool ReachabilityIndex::mayReach(int a, int b) const {
+    if (a > b) {
+        return false; // Topological order
+    }
+    for (int label = 0; label < REACH_LABELS; ++label) {
+        if (low[label][b] < low[label][a] || post[label][b] > post[label][a]) {
+            return false; // b's interval is not inside a's
+        }
+    }
+    return true;
+}
+
+bool ReachabilityIndex::reaches(int u, int v) const {
+    int from = dag.componentOf[u];
+    int to = dag.componentOf[v];
+    if (from == to) {
+        return true;
+    }
+    if (!mayReach(from, to)) {
+        return false;
+    }
+    // Search, entering only components the labels cannot rule out
+    vector<bool> visited(to - from + 1, false); // Only ids between from and to can be on a path
+    vector<int> stack(1, from);
+    while (!stack.empty()) {
+        int c = stack.back();
+        stack.pop_back();
+        for (int i = dag.offsets[c]; i < dag.offsets[c + 1]; ++i) {
+            int next = dag.targets[i];
+            if (next == to) {
+                return true;
+            }
+            if (next < to && !visited[next - from] && mayReach(next, to)) {
+                visited[next - from] = true;
+                stack.push_back(next);
+            }
+        }
+    }
+    return false;
+}
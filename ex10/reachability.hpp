@@ -0,0 +1,46 @@
+#ifndef REACHABILITY_HPP
+#define REACHABILITY_HPP
+
+#include <vector>
+#include "kosaraju_vector_list.hpp"
+
+/*
+Reachability queries answered from the condensation DAG instead of a traversal of the graph.
+
+Vertices reach each other exactly when their components do, and components are numbered in
+topological order, so a component can only reach higher ids. On top of that every component
+gets REACH_LABELS interval labels (GRAIL): each label comes from a DFS over the DAG in a
+different random order, and is [lowest post-order number below the component, its own
+post-order number]. If a reaches b, b's interval lies inside a's in every label; when it does
+not, the answer is "no" without any search. Only the remaining queries search the DAG, pruning
+every branch the labels or the topological order rule out.
+*/
+
+/// @brief Number of interval labels per component.
+const int REACH_LABELS = 2;
+
+/// @brief Reachability index over the condensation of one version of the graph.
+class ReachabilityIndex {
+public:
+    /// @brief Builds the labels, O(REACH_LABELS * (components + component edges)).
+    /// @param condensation The condensation of the graph (taken over).
+    explicit ReachabilityIndex(Condensation condensation);
+
+    /// @brief Tells whether u reaches v. Safe to call from several threads at once.
+    /// @param u The start vertex (0-based).
+    /// @param v The end vertex (0-based).
+    bool reaches(int u, int v) const;
+
+    /// @brief The condensation the index was built over.
+    const Condensation& condensation() const { return dag; }
+
+private:
+    Condensation dag;                      ///< The indexed DAG.
+    std::vector<int> low[REACH_LABELS];    ///< Per label: lowest post-order number reachable from each component.
+    std::vector<int> post[REACH_LABELS];   ///< Per label: post-order number of each component.
+
+    /// @brief Returns false if the labels prove that component a cannot reach component b.
+    bool mayReach(int a, int b) const;
+};
+
+#endif // REACHABILITY_HPP
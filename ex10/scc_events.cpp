@@ -0,0 +1,147 @@
+#include "scc_events.hpp"
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+static const size_t EVENT_QUEUE_LIMIT = 1024;      // Events kept per subscriber before dropping the oldest
+static const size_t EVENT_HIGH_WATER = 64 * 1024;  // Unsent bytes after which delivery waits for the socket
+
+/// Protects subscribers and SccSubscriber::conn
+static mutex hubMutex;
+/// Current subscriptions
+static vector<shared_ptr<SccSubscriber>> subscribers;
+
+// Runs on the thread driving the connection: hands queued events over while the socket keeps up.
+static void deliverSccEvents(const shared_ptr<SccSubscriber>& sub) {
+    Connection* conn = sub->conn; // Only this thread clears it
+    if (!conn) {
+        return;
+    }
+    while (conn->pendingOutput() < EVENT_HIGH_WATER) {
+        string events;
+        {
+            lock_guard<mutex> lock(sub->queueMutex);
+            if (sub->queue.empty()) {
+                sub->scheduled = false;
+                return;
+            }
+            if (sub->dropped > 0) {
+                events = "EVENT dropped " + to_string(sub->dropped) + "\n";
+                sub->dropped = 0;
+            }
+            events += sub->queue.front();
+            sub->queue.pop_front();
+        }
+        conn->push(std::move(events));
+    }
+    conn->whenDrained([sub]() { deliverSccEvents(sub); }); // The client is behind: wait for it
+}
+
+// Returns true if the largest SCC covers at least percent of the vertices.
+static bool reaches(const SccState& state, int percent) {
+    return state.vertices > 0 && static_cast<long>(state.largest) * 100 >= static_cast<long>(percent) * state.vertices;
+}
+
+// Formats the events a change produces for one subscriber (empty if none).
+static string formatEvents(const SccSubscriber& sub, const SccState& before, const SccState& after, SccChange change) {
+    string events;
+    for (int percent : sub.thresholds) {
+        bool was = reaches(before, percent);
+        bool is = reaches(after, percent);
+        if (was != is) {
+            events += "EVENT threshold " + to_string(percent) + (is ? " reached" : " lost") +
+                      ": largest SCC " + to_string(after.largest) + " of " + to_string(after.vertices) + " vertices\n";
+        }
+    }
+    if (sub.merges && change == SCC_EDGE_ADDED && after.components < before.components) {
+        events += "EVENT merge: " + to_string(before.components - after.components + 1) +
+                  " SCCs merged, largest SCC " + to_string(after.largest) + "\n";
+    }
+    if (sub.splits && change == SCC_EDGE_REMOVED && after.components > before.components) {
+        events += "EVENT split: an SCC split into " + to_string(after.components - before.components + 1) +
+                  ", largest SCC " + to_string(after.largest) + "\n";
+    }
+    if (sub.counts && after.components != before.components) {
+        events += "EVENT components " + to_string(before.components) + " -> " + to_string(after.components) + "\n";
+    }
+    return events;
+}
+
+string subscribeScc(Connection* conn, const string& args) {
+    shared_ptr<SccSubscriber> sub = make_shared<SccSubscriber>();
+    sub->merges = sub->splits = sub->counts = false;
+    sub->conn = conn;
+    bool any = false;
+    stringstream ss(args);
+    string word;
+    while (ss >> word) {
+        any = true;
+        if (word == "merge") {
+            sub->merges = true;
+        } else if (word == "split") {
+            sub->splits = true;
+        } else if (word == "count") {
+            sub->counts = true;
+        } else {
+            int percent = atoi(word.c_str());
+            if (percent < 1 || percent > 100) {
+                return "Invalid subscription: " + word + "\n";
+            }
+            sub->thresholds.push_back(percent);
+        }
+    }
+    if (!any) { // Everything, at the threshold the monitor reports
+        sub->merges = sub->splits = sub->counts = true;
+        sub->thresholds.push_back(50);
+    }
+    sort(sub->thresholds.begin(), sub->thresholds.end());
+    sub->thresholds.erase(unique(sub->thresholds.begin(), sub->thresholds.end()), sub->thresholds.end());
+
+    unsubscribeScc(conn);
+    lock_guard<mutex> lock(hubMutex);
+    subscribers.push_back(sub);
+    return "Subscribed to SCC events\n";
+}
+
+bool unsubscribeScc(Connection* conn) {
+    lock_guard<mutex> lock(hubMutex);
+    for (size_t i = 0; i < subscribers.size(); ++i) {
+        if (subscribers[i]->conn == conn) {
+            subscribers[i]->conn = nullptr; // Deliveries already posted find nothing to write to
+            subscribers[i] = subscribers.back();
+            subscribers.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void publishSccChange(const SccState& before, const SccState& after, SccChange change) {
+    lock_guard<mutex> lock(hubMutex);
+    for (const shared_ptr<SccSubscriber>& sub : subscribers) {
+        string events = formatEvents(*sub, before, after, change);
+        if (events.empty()) {
+            continue;
+        }
+        bool post = false;
+        {
+            lock_guard<mutex> queueLock(sub->queueMutex);
+            if (sub->queue.size() >= EVENT_QUEUE_LIMIT) {
+                sub->queue.pop_front(); // Backpressure: the slow client loses its oldest event
+                sub->dropped++;
+            }
+            sub->queue.push_back(std::move(events));
+            if (!sub->scheduled) {
+                sub->scheduled = post = true;
+            }
+        }
+        if (post) {
+            shared_ptr<SccSubscriber> target = sub;
+            if (!sub->conn->postBack([target]() { deliverSccEvents(target); })) {
+                lock_guard<mutex> queueLock(sub->queueMutex);
+                sub->scheduled = false; // Retried on the next event
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef SCC_EVENTS_HPP
+#define SCC_EVENTS_HPP
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../ex8/connection.hpp"
+
+/*
+Push-based SCC events.
+
+A client sends SUBSCRIBE once and from then on receives a line starting with "EVENT" whenever
+the SCC structure changes in a way it asked for, instead of polling with Kosaraju. The
+mutation paths publish every change; each subscriber has its own bounded queue, drained on
+the thread driving its connection only as fast as its socket takes the data. A slow client
+therefore never blocks the graph or the other subscribers: once its queue is full, its oldest
+events are dropped and it is told how many it missed.
+*/
+
+/// @brief The SCC figures events are derived from.
+struct SccState {
+    int vertices;   ///< Number of vertices in the graph.
+    int largest;    ///< Size of the largest SCC.
+    int components; ///< Number of SCCs.
+};
+
+/// @brief What changed the graph.
+enum SccChange {
+    SCC_NEW_GRAPH,   ///< A new graph replaced the old one.
+    SCC_EDGE_ADDED,  ///< An edge was added (SCCs can only merge).
+    SCC_EDGE_REMOVED ///< An edge was removed (SCCs can only split).
+};
+
+/// @brief A subscribed client.
+struct SccSubscriber {
+    std::vector<int> thresholds; ///< Percentages of the vertices the largest SCC is watched against.
+    bool merges;                 ///< Report SCCs merging.
+    bool splits;                 ///< Report an SCC splitting.
+    bool counts;                 ///< Report changes in the number of SCCs.
+    Connection* conn;            ///< Connection to deliver to; nullptr once unsubscribed.
+    std::mutex queueMutex;       ///< Protects queue, dropped and scheduled.
+    std::deque<std::string> queue; ///< Events not yet handed to the connection.
+    size_t dropped = 0;          ///< Events discarded since the last delivery.
+    bool scheduled = false;      ///< A delivery is posted or waiting for the socket to drain.
+};
+
+/// @brief Registers a connection for SCC events, replacing an earlier subscription.
+/// Must be called on the thread driving the connection.
+/// @param conn The connection.
+/// @param args What to report: any of "merge", "split", "count" and percentages (1-100);
+///             empty for everything with a 50% threshold.
+/// @return The reply to send to the client.
+std::string subscribeScc(Connection* conn, const std::string& args);
+
+/// @brief Removes the subscription of a connection, if any.
+/// Must be called on the thread driving the connection, before it is freed.
+/// @param conn The connection.
+/// @return true if the connection was subscribed.
+bool unsubscribeScc(Connection* conn);
+
+/// @brief Queues the events a change produces for every interested subscriber.
+/// Safe to call from any thread; never waits for a client.
+/// @param before SCC figures before the change.
+/// @param after SCC figures after the change.
+/// @param change What changed the graph.
+void publishSccChange(const SccState& before, const SccState& after, SccChange change);
+
+#endif // SCC_EVENTS_HPP
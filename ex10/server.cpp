@@ -12,178 +12,753 @@
 #include <sys/socket.h>
 #include <pthread.h>
 #include <sstream>
-#include <condition_variable>
+#include <atomic>
+#include <optional>
+#include <poll.h>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <sched.h>
 #include "kosaraju_vector_list.hpp"
+#include "scc_events.hpp"
+#include "../common/mpsc_queue.hpp"
+#include "graph_wal.hpp"
+#include "graph_file.hpp"
+#include "data_dir.hpp"
+#include "external_scc.hpp"
+#include "reachability.hpp"
+#include "transitive_closure.hpp"
 #include "../ex8/reactor.hpp"
+#include "../ex8/uring_proactor.hpp"
+#include "../ex8/connection.hpp"
+#include "../ex8/scheduler.hpp"
 
 using namespace std;
 
 /// Mutex for synchronizing access to the graph
 mutex graphMutex;
-/// Condition variable for signaling the monitoring thread
-condition_variable graphCondVar;
 /// Pointer to the current graph
 KosarajuVectorList* graph = nullptr;
-/// Flag to indicate if 50% SCC condition is met
-bool sccConditionMet = false;
-bool sccConditionWasMet = false;
 
-/// @brief Processes commands received from the client.
-/// @param clientSocket The socket of the client.
-/// @param command The command received from the client.
-void processCommand(int clientSocket, const string& command);
+/// Number of mutations applied so far; tells whether the reachability index is stale. Guarded by graphMutex
+unsigned long graphVersion = 0;
 
-/// @brief Handles a connected client.
-/// @param clientSocket The socket of the client.
-/// @return nullptr
-void* handleClient(int clientSocket) {
-    char buffer[1024];
-    memset(buffer, 0, 1024); // Clear the buffer
-    int nbytes;
-    while ((nbytes = read(clientSocket, buffer, 1023)) > 0) { // Read data from client
-        processCommand(clientSocket, string(buffer)); // Process the command
-        memset(buffer, 0, 1024); // Clear the buffer for the next read
+/// @brief A change of the graph's SCCs, passed from the mutation paths to the monitoring thread.
+struct MonitorEvent {
+    SccState before;  ///< SCC figures before the change.
+    SccState after;   ///< SCC figures after the change.
+    SccChange change; ///< What changed the graph.
+};
+/// Changes waiting for the monitor, in the order they were made
+MpscQueue<MonitorEvent> monitorQueue;
+/// Bumped after every push to monitorQueue; the monitor waits on it
+atomic<unsigned long> monitorSignal{0};
+
+/// @brief Current SCC figures of the graph (all 0 without one).
+/// Must be called with graphMutex held.
+SccState sccState() {
+    if (!graph) {
+        return SccState{0, 0, 0};
     }
-    
-    if (nbytes == 0) {
-        cout << "Socket " << clientSocket << " hung up" << endl; // Log if the client disconnected
-    } else {
-        cerr << "Error on read" << endl; // Log read error
+    return SccState{graph->getNumVertices(), graph->largestSCCSize(), graph->numComponents()};
+}
+
+/// @brief Queues a change for the monitor.
+/// Called with graphMutex held so changes arrive in order; only a lock-free push happens here.
+/// @param before SCC figures before the change.
+/// @param change What changed the graph.
+void recordSccChange(const SccState& before, SccChange change) {
+    monitorQueue.push(MonitorEvent{before, sccState(), change});
+}
+
+/// @brief Wakes the monitor. Called after graphMutex has been released.
+void wakeMonitor() {
+    monitorSignal.fetch_add(1, memory_order_release);
+    monitorSignal.notify_one();
+}
+
+/// @brief A staged NewEdge/RemoveEdge, not yet applied to the graph.
+struct EdgeUpdate {
+    int u;    ///< Start vertex (1-based).
+    int v;    ///< End vertex (1-based).
+    bool add; ///< true for NewEdge, false for RemoveEdge.
+};
+/// Staged edge updates, appended without taking graphMutex
+MpscQueue<EdgeUpdate> stagedUpdates;
+/// Number of staged updates not yet applied; the applier thread waits on it
+atomic<long> stagedCount{0};
+/// Vertices of the current graph (0 without one), readable without graphMutex
+atomic<int> graphVertices{0};
+/// Staged updates after which the thread staging one applies the batch itself
+const long APPLY_BATCH = 4096;
+/// How long the applier thread lets updates accumulate before applying them
+const chrono::milliseconds APPLY_INTERVAL(5);
+
+/// @brief Applies staged edge updates to the graph, in the order they were staged.
+/// Must be called with graphMutex held, which also makes the caller the queue's only consumer.
+/// @param complete true to wait out producers halfway through a push, so that every update
+///                 acknowledged before the call is applied (reads need this); false to take
+///                 only what is ready.
+/// @return Number of updates applied.
+long applyStagedUpdates(bool complete) {
+    long target = complete ? stagedCount.load(memory_order_acquire) : 0;
+    long applied = 0;
+    EdgeUpdate update;
+    while (true) {
+        if (!stagedUpdates.pop(update)) {
+            if (applied >= target) {
+                break;
+            }
+            sched_yield(); // A producer is between its exchange and its link: it finishes shortly
+            continue;
+        }
+        stagedCount.fetch_sub(1, memory_order_acq_rel);
+        applied++;
+        int n = graph ? graph->getNumVertices() : 0;
+        if (update.u < 1 || update.v < 1 || update.u > n || update.v > n) {
+            continue; // Staged against a graph that has since been replaced by a smaller one
+        }
+        SccState before = sccState();
+        if (update.add) {
+            graph->addEdge(update.u, update.v); // Add the edge
+            recordSccChange(before, SCC_EDGE_ADDED);
+        } else {
+            graph->removeEdge(update.u, update.v); // Remove the edge
+            recordSccChange(before, SCC_EDGE_REMOVED);
+        }
+        logEdgeUpdate(update.u, update.v, update.add); // In the order applied; the sync thread flushes it
+        graphVersion++;
     }
+    return applied;
+}
 
-    close(clientSocket); // Close the socket
+/// @brief Stages an edge update without taking graphMutex (unless the batch is full).
+/// @param update The update; its vertices must be valid for the current graph.
+void stageEdgeUpdate(const EdgeUpdate& update) {
+    stagedUpdates.push(update);
+    long count = stagedCount.fetch_add(1, memory_order_acq_rel) + 1;
+    if (count == 1) {
+        stagedCount.notify_one(); // Wakes the applier thread
+    } else if (count >= APPLY_BATCH && graphMutex.try_lock()) { // Nobody is applying: do it now
+        applyStagedUpdates(false);
+        graphMutex.unlock();
+        wakeMonitor();
+    }
+}
+
+/// @brief Checkpoints the graph log once its current segment has grown large.
+/// graphMutex is held only to start a new segment and take an O(1) snapshot; the checkpoint
+/// is written from the snapshot without the lock.
+void checkpointGraphLog() {
+    if (!graphLogNeedsCheckpoint()) {
+        return;
+    }
+    graphMutex.lock(); // Lock the graph mutex
+    long segment = beginGraphCheckpoint();
+    optional<GraphSnapshot> snapshot;
+    if (segment >= 0 && graph) {
+        snapshot = graph->snapshot();
+    }
+    graphMutex.unlock(); // Unlock the graph mutex
+    if (segment >= 0) {
+        writeGraphCheckpoint(segment, snapshot ? &*snapshot : nullptr);
+    }
+}
+
+/// @brief Applier thread function: applies staged edge updates shortly after they arrive.
+/// @return nullptr
+void* applyStagedEdges(void*) {
+    while (true) {
+        stagedCount.wait(0, memory_order_acquire); // Sleep while nothing is staged
+        this_thread::sleep_for(APPLY_INTERVAL); // Let a batch build up
+        graphMutex.lock();
+        long applied = applyStagedUpdates(false);
+        graphMutex.unlock();
+        if (applied > 0) {
+            wakeMonitor();
+            cout << "Applied " << applied << " staged edge updates" << endl; // Log to console
+        }
+        checkpointGraphLog();
+    }
     return nullptr;
 }
 
-/// @brief Processes commands received from the client.
-/// @param clientSocket The socket of the client.
+/// @brief Snapshots the graph, including every acknowledged edge update.
+/// graphMutex is held only for the O(1) snapshot; the caller reads it without the lock.
+/// @return The snapshot, or std::nullopt without a graph.
+optional<GraphSnapshot> takeSnapshot() {
+    graphMutex.lock(); // Lock the graph mutex
+    bool applied = applyStagedUpdates(true) > 0; // Read what has been acknowledged
+    optional<GraphSnapshot> snapshot;
+    if (graph) {
+        snapshot = graph->snapshot();
+    }
+    graphMutex.unlock(); // Unlock the graph mutex
+    if (applied) {
+        wakeMonitor();
+    }
+    return snapshot;
+}
+
+/// @brief Replaces the shared graph. graphMutex is held only for the swap: the old graph, whose
+/// chunks may number in the millions, is freed after the unlock.
+/// @param newGraph The new graph, built without the lock.
+/// @param edges Its edges (1-based), for the graph log.
+/// @return A snapshot of the new graph.
+GraphSnapshot replaceGraph(KosarajuVectorList* newGraph, const vector<pair<int, int>>& edges) {
+    int n = newGraph->getNumVertices();
+    graphMutex.lock(); // Lock the graph mutex
+    applyStagedUpdates(true); // Updates staged before the new graph still apply to the old one
+    SccState before = sccState();
+    KosarajuVectorList* oldGraph = graph;
+    graph = newGraph;
+    graphVersion++;
+    graphVertices.store(n, memory_order_release);
+    logNewGraph(n, edges);
+    recordSccChange(before, SCC_NEW_GRAPH);
+    GraphSnapshot snapshot = graph->snapshot();
+    graphMutex.unlock(); // Unlock the graph mutex
+    delete oldGraph; // Every free() happens outside the lock; snapshots keep the chunks they share
+    wakeMonitor();
+    syncGraphLog(); // The graph is on disk before the client hears it succeeded
+    checkpointGraphLog();
+    return snapshot;
+}
+
+/// @brief Replaces the shared graph with one uploaded by a client.
+/// @param n Number of vertices.
+/// @param edges Edges of the new graph.
+/// @return The response to send to the client.
+string createGraph(int n, const vector<pair<int, int>>& edges) {
+    int m = static_cast<int>(edges.size());
+    GraphSnapshot snapshot = replaceGraph(new KosarajuVectorList(n, edges), edges); // Create a new graph with the provided edges
+
+    string response = "Graph created successfully with " + to_string(n) + " vertices and " + to_string(m) + " edges\n";
+    stringstream ss;
+    snapshot.printGraph(ss); // Print the graph (not through cout: other threads keep logging to it)
+    response += ss.str(); // Append the graph structure
+
+    cout << "Graph created with " << n << " vertices and " << m << " edges" << endl; // Log to console
+    return response;
+}
+
+/// @brief Writes the graph to a binary snapshot file.
+/// @param name Name of the file in the data directory.
+/// @return The response to send to the client.
+string saveGraph(const string& name) {
+    string path, error;
+    if (!resolveDataPath(name, path, error)) {
+        return "Cannot save graph: " + error + "\n";
+    }
+    graphMutex.lock(); // Lock the graph mutex
+    bool applied = applyStagedUpdates(true) > 0; // Save what has been acknowledged
+    optional<GraphSnapshot> snapshot;
+    vector<int> componentIds;
+    if (graph) {
+        snapshot = graph->snapshot();
+        componentIds = graph->componentIds(); // O(n) copy: lets LOAD skip computing the SCCs
+    }
+    graphMutex.unlock(); // Unlock the graph mutex
+    if (applied) {
+        wakeMonitor();
+    }
+    if (!snapshot) {
+        return "No graph to save\n";
+    }
+    if (!saveGraphFile(path, *snapshot, &componentIds, error)) { // Written from the snapshot, without the lock
+        return "Cannot save graph: " + error + "\n";
+    }
+    cout << "Graph saved to " << path << endl; // Log to console
+    return "Graph saved to " + name + " with " + to_string(snapshot->getNumVertices()) + " vertices\n";
+}
+
+/// @brief Replaces the shared graph with one from a binary snapshot file.
+/// @param name Name of the file in the data directory.
+/// @return The response to send to the client.
+string loadGraph(const string& name) {
+    MappedGraphFile file;
+    string path, error;
+    if (!resolveDataPath(name, path, error) || !file.open(path, error)) {
+        return "Cannot load graph: " + error + "\n";
+    }
+    KosarajuVectorList* loaded = new KosarajuVectorList(file.view()); // Copied out of the mapping, no parsing
+    replaceGraph(loaded, graphLogEnabled() ? file.edges() : vector<pair<int, int>>());
+    int n = file.view().n;
+    cout << "Graph loaded from " << path << " with " << n << " vertices and " << file.numEdges() << " edges" << endl; // Log to console
+    return "Graph loaded from " + name + " with " + to_string(n) + " vertices and " + to_string(file.numEdges()) + " edges\n";
+}
+
+/// Serializes rebuilding the reachability index; protects reachIndex and reachIndexVersion
+mutex reachIndexMutex;
+/// Reachability index of the graph as of reachIndexVersion (nullptr before the first Reach)
+shared_ptr<const ReachabilityIndex> reachIndex;
+/// graphVersion reachIndex was built from
+unsigned long reachIndexVersion = 0;
+
+/// @brief Returns the reachability index of the current graph, rebuilding it if the graph changed.
+/// The rebuild works on a snapshot without graphMutex; concurrent callers wait for it and share it.
+/// @return The index, or nullptr without a graph.
+shared_ptr<const ReachabilityIndex> currentReachIndex() {
+    lock_guard<mutex> rebuild(reachIndexMutex);
+    graphMutex.lock(); // Lock the graph mutex
+    bool applied = applyStagedUpdates(true) > 0; // Answer for what has been acknowledged
+    bool hasGraph = graph != nullptr;
+    unsigned long version = graphVersion;
+    optional<GraphSnapshot> snapshot;
+    if (hasGraph && (!reachIndex || reachIndexVersion != version)) {
+        snapshot = graph->snapshot();
+    }
+    graphMutex.unlock(); // Unlock the graph mutex
+    if (applied) {
+        wakeMonitor();
+    }
+    if (!hasGraph) {
+        return nullptr;
+    }
+    if (snapshot) { // Stale: rebuild lazily, only now that somebody asks
+        reachIndex = make_shared<const ReachabilityIndex>(snapshot->condense());
+        reachIndexVersion = version;
+    }
+    return reachIndex;
+}
+
+/// @brief Answers SameSCC and Reach point queries.
+/// @param command The command ("SameSCC u v" or "Reach u v").
+/// @return The response to send to the client (empty without a graph).
+string pointQuery(const string& command) {
+    bool sameScc = command[0] == 'S';
+    int u = 0, v = 0;
+    if (sscanf(command.c_str(), sameScc ? "SameSCC %d %d" : "Reach %d %d", &u, &v) != 2) {
+        return "Invalid command\n";
+    }
+    int n = graphVertices.load(memory_order_acquire);
+    if (n == 0) {
+        return "";
+    }
+    if (u < 1 || v < 1 || u > n || v > n) {
+        return "Invalid vertex: " + to_string(u < 1 || u > n ? u : v) + "\n";
+    }
+    string pair = to_string(u) + " and " + to_string(v);
+    graphMutex.lock(); // Lock the graph mutex
+    bool applied = applyStagedUpdates(true) > 0;
+    bool together = graph && u <= graph->getNumVertices() && v <= graph->getNumVertices() &&
+                    graph->componentIds()[u - 1] == graph->componentIds()[v - 1]; // Kept up to date by every mutation: O(1)
+    graphMutex.unlock(); // Unlock the graph mutex
+    if (applied) {
+        wakeMonitor();
+    }
+    if (sameScc) {
+        return pair + (together ? " are in the same SCC\n" : " are not in the same SCC\n");
+    }
+    if (!together) { // The same SCC answers Reach too; otherwise ask the index
+        shared_ptr<const ReachabilityIndex> index = currentReachIndex();
+        if (!index || u > index->condensation().numVertices() || v > index->condensation().numVertices() || !index->reaches(u - 1, v - 1)) {
+            return to_string(u) + " cannot reach " + to_string(v) + "\n";
+        }
+    }
+    return to_string(u) + " can reach " + to_string(v) + "\n";
+}
+
+/// @brief Computes the SCCs of a graph file without loading it; the served graph is not involved.
+/// @param name Name of the file in the data directory.
+/// @return The response to send to the client.
+string externalGraphSCCs(const string& name) {
+    ExternalSccResult result;
+    string path, error;
+    if (!resolveDataPath(name, path, error) || !externalSCCs(path, result, error)) {
+        return "Cannot compute SCCs: " + error + "\n";
+    }
+    cout << "External SCCs of " << path << " computed in " << result.passes << " passes" << endl; // Log to console
+    return "External SCCs of " + name + ": " + to_string(result.components) + " SCCs, the largest has " + to_string(result.largest) +
+           " of " + to_string(result.componentOf.size()) + " vertices (" + to_string(result.passes) + " passes over " +
+           to_string(result.edges) + " edges)\n";
+}
+
+/// Bytes the bit rows of one transitive closure block may take
+const size_t CLOSURE_MEMORY_LIMIT = size_t(256) << 20;
+
+/// @brief Computes the transitive closure of the current graph's condensation.
+/// @param name File in the data directory to write the closure to, or empty to only count the reachable pairs.
+/// @return The response to send to the client (empty without a graph).
+string graphClosure(const string& name) {
+    string path, error;
+    if (!name.empty() && !resolveDataPath(name, path, error)) {
+        return "Cannot save transitive closure: " + error + "\n";
+    }
+    optional<GraphSnapshot> snapshot = takeSnapshot();
+    if (!snapshot) {
+        return "";
+    }
+    Condensation dag = snapshot->condense();
+    long pairs = 0;
+    int blocks = 0;
+    if (name.empty()) {
+        pairs = transitiveClosure(dag, CLOSURE_MEMORY_LIMIT, nullptr, blocks);
+    } else if (!saveTransitiveClosure(path, dag, CLOSURE_MEMORY_LIMIT, pairs, blocks, error)) {
+        return "Cannot save transitive closure: " + error + "\n";
+    }
+    cout << "Transitive closure of " << dag.numComponents() << " components computed in " << blocks << " blocks" << endl; // Log to console
+    return "Transitive closure of " + to_string(dag.numComponents()) + " components: " + to_string(pairs) +
+           " reachable pairs of distinct components" + (name.empty() ? "" : ", saved to " + name) + "\n";
+}
+
+/// @brief Returns the argument of a command, without surrounding spaces.
+/// @param command The command.
+/// @param length Length of the command name.
+string commandArgument(const string& command, size_t length) {
+    size_t start = command.find_first_not_of(' ', length);
+    size_t end = command.find_last_not_of(" \r");
+    return start == string::npos ? "" : command.substr(start, end - start + 1);
+}
+
+/// @brief Processes a single-line command received from the client.
 /// @param command The command received from the client.
-void processCommand(int clientSocket, const string& command) {
+/// @return The response to send to the client (empty if there is nothing to send).
+string processCommand(const string& command) {
     string response;
-    if (command.find("NewGraph") == 0) {
-        int n, m;
-        sscanf(command.c_str(), "NewGraph %d %d", &n, &m); // Parse the number of vertices and edges
-        vector<pair<int, int>> edges(m); // Create a vector to store edges
-        response = "Creating new graph...\n";
-        response += "Number of vertices: " + to_string(n) + ", Number of edges: " + to_string(m) + "\n";
-        response += "Please provide the edges one by one:\n";
-        write(clientSocket, response.c_str(), response.size()); // Send response to client
-        
-        for (int i = 0; i < m; ++i) { // Loop to receive edges from the client
-            char buffer[1024];
-            memset(buffer, 0, 1024); // Clear the buffer
-            read(clientSocket, buffer, 1023); // Read edge from client
-            sscanf(buffer, "%d %d", &edges[i].first, &edges[i].second); // Parse the edge
-            response = "Edge " + to_string(i + 1) + ": " + to_string(edges[i].first) + " -> " + to_string(edges[i].second) + "\n";
-            write(clientSocket, response.c_str(), response.size()); // Send edge information back to client
-        }
-        
-        graphMutex.lock(); // Lock the graph mutex
-        delete graph; // Delete the existing graph
-        graph = new KosarajuVectorList(n, edges); // Create a new graph with the provided edges
-        sccConditionMet = false; // Reset the SCC condition flag
-        sccConditionWasMet = false; // Reset the previous SCC condition flag
-        graphMutex.unlock(); // Unlock the graph mutex
-        response = "Graph created successfully with " + to_string(n) + " vertices and " + to_string(m) + " edges\n";
-        write(clientSocket, response.c_str(), response.size()); // Send confirmation to client
-
-        stringstream ss;
-        streambuf* coutbuf = cout.rdbuf(); // Save old buffer
-        cout.rdbuf(ss.rdbuf()); // Redirect cout to stringstream
-        graph->printGraph(); // Print the graph
-        cout.rdbuf(coutbuf); // Reset cout to its old buffer
-        response = ss.str(); // Get the string from stringstream
-        write(clientSocket, response.c_str(), response.size()); // Send graph structure to client
-
-        cout << "Graph created with " << n << " vertices and " << m << " edges" << endl; // Log to console
-    } else if (command.find("Kosaraju") == 0) {
-        graphMutex.lock(); // Lock the graph mutex
-        if (graph) {
-            graph->findSCCs(); // Find strongly connected components
+    if (command.find("Kosaraju") == 0) {
+        optional<GraphSnapshot> snapshot = takeSnapshot();
+        if (snapshot) { // Computed on the snapshot: mutations go on meanwhile
             stringstream ss;
-            streambuf* coutbuf = cout.rdbuf(); // Save old buffer
-            cout.rdbuf(ss.rdbuf()); // Redirect cout to stringstream
-            graph->printSCCs(); // Print SCCs
-            cout.rdbuf(coutbuf); // Reset cout to its old buffer
+            GraphSnapshot::printSCCs(snapshot->findSCCs(), ss); // Find and print the SCCs
             response = ss.str();
             response += "Kosaraju algorithm executed\n";
-            write(clientSocket, response.c_str(), response.size()); // Send response to client
             cout << "Kosaraju algorithm executed" << endl; // Log to console
-
-            // Check SCC condition
-            int largestSCC = graph->largestSCCSize();
-            bool previousConditionMet = sccConditionMet;
-            sccConditionMet = largestSCC >= graph->getNumVertices() / 2;
-
-            if (sccConditionMet != previousConditionMet) {
-                graphCondVar.notify_all(); // Notify the monitoring thread
-            }
         }
-        graphMutex.unlock(); // Unlock the graph mutex
-    } else if (command.find("NewEdge") == 0) {
-        int u, v;
-        sscanf(command.c_str(), "NewEdge %d %d", &u, &v); // Parse the edge to add
-        graphMutex.lock(); // Lock the graph mutex
-        if (graph) {
-            graph->addEdge(u, v); // Add the edge
-            response = "Edge added successfully: " + to_string(u) + " -> " + to_string(v) + "\n";
-            write(clientSocket, response.c_str(), response.size()); // Send confirmation to client
-            cout << "Edge added: " << u << " -> " << v << endl; // Log to console
-        }
-        graphMutex.unlock(); // Unlock the graph mutex
-    } else if (command.find("RemoveEdge") == 0) {
-        int u, v;
-        sscanf(command.c_str(), "RemoveEdge %d %d", &u, &v); // Parse the edge to remove
-        graphMutex.lock(); // Lock the graph mutex
-        if (graph) {
-            graph->removeEdge(u, v); // Remove the edge
-            response = "Edge removed successfully: " + to_string(u) + " -> " + to_string(v) + "\n";
-            write(clientSocket, response.c_str(), response.size()); // Send confirmation to client
-            cout << "Edge removed: " << u << " -> " << v << endl; // Log to console
-        }
-        graphMutex.unlock(); // Unlock the graph mutex
+    } else if (command.find("NewEdge") == 0 || command.find("RemoveEdge") == 0) {
+        bool add = command[0] == 'N';
+        int u = 0, v = 0;
+        sscanf(command.c_str(), add ? "NewEdge %d %d" : "RemoveEdge %d %d", &u, &v); // Parse the edge
+        int n = graphVertices.load(memory_order_acquire);
+        if (n > 0 && (u < 1 || v < 1 || u > n || v > n)) {
+            response = "Invalid edge: " + to_string(u) + " -> " + to_string(v) + "\n";
+        } else if (n > 0) {
+            stageEdgeUpdate(EdgeUpdate{u, v, add}); // Applied in a batch; reads see it
+            response = string(add ? "Edge added" : "Edge removed") + " successfully: " + to_string(u) + " -> " + to_string(v) + "\n";
+        }
+    } else if (command.find("SameSCC ") == 0 || command.find("Reach ") == 0) {
+        response = pointQuery(command);
+    } else if (command.find("Condensation") == 0) {
+        optional<GraphSnapshot> snapshot = takeSnapshot();
+        if (snapshot) { // Built server-side: clients get the component graph, not every edge
+            stringstream ss;
+            snapshot->condense().print(ss);
+            response = ss.str();
+        }
+    } else if (command.find("Closure") == 0) {
+        response = graphClosure(commandArgument(command, 7));
     } else if (command.find("PrintGraph") == 0) {
-        graphMutex.lock(); // Lock the graph mutex
-        if (graph) {
+        optional<GraphSnapshot> snapshot = takeSnapshot();
+        if (snapshot) {
             stringstream ss;
-            streambuf* coutbuf = cout.rdbuf(); // Save old buffer
-            cout.rdbuf(ss.rdbuf()); // Redirect cout to stringstream
-            graph->printGraph(); // Print the graph
-            cout.rdbuf(coutbuf); // Reset cout to its old buffer
+            snapshot->printGraph(ss); // Print the graph
             response = ss.str();
-            write(clientSocket, response.c_str(), response.size()); // Send graph structure to client
         }
-        graphMutex.unlock(); // Unlock the graph mutex
+    } else if (command.find("SAVE ") == 0 || command.find("LOAD ") == 0) {
+        string name = commandArgument(command, 5);
+        if (name.empty()) {
+            response = "Invalid command\n";
+        } else {
+            response = command[0] == 'S' ? saveGraph(name) : loadGraph(name);
+        }
+    } else if (command.find("ExternalSCC ") == 0) {
+        string name = commandArgument(command, 12);
+        response = name.empty() ? "Invalid command\n" : externalGraphSCCs(name);
     } else if (command.find("exit") == 0) {
         response = "Exiting...\n";
-        write(clientSocket, response.c_str(), response.size()); // Send response to client
     } else {
         response = "Invalid command\n";
-        write(clientSocket, response.c_str(), response.size()); // Send response to client
     }
+    return response;
+}
+
+/// @brief Runs the protocol with one client as a coroutine.
+/// The NewGraph dialog reads its edges sequentially; between lines the coroutine is suspended
+/// and costs only its frame, whichever backend drives the connection.
+/// @param conn The connection of the client.
+SessionTask clientSession(Connection* conn) {
+    struct Unsubscriber { // Ends the SCC event subscription however the session ends
+        Connection* conn;
+        ~Unsubscriber() { unsubscribeScc(conn); }
+    } unsubscriber{conn};
+    while (optional<string> command = co_await conn->readLine()) {
+        if (command->find("SUBSCRIBE") == 0) {
+            if (!co_await conn->write(subscribeScc(conn, command->substr(9)))) {
+                co_return;
+            }
+        } else if (command->find("UNSUBSCRIBE") == 0) {
+            string response = unsubscribeScc(conn) ? "Unsubscribed from SCC events\n" : "Not subscribed\n";
+            if (!co_await conn->write(response)) {
+                co_return;
+            }
+        } else if (command->find("NewGraph") == 0) {
+            int n = 0, m = 0;
+            sscanf(command->c_str(), "NewGraph %d %d", &n, &m); // Parse the number of vertices and edges
+            m = max(m, 0);
+            string response = "Creating new graph...\n";
+            response += "Number of vertices: " + to_string(n) + ", Number of edges: " + to_string(m) + "\n";
+            response += "Please provide the edges one by one:\n";
+            co_await conn->write(response); // Send response to client
+
+            vector<pair<int, int>> edges(m); // Create a vector to store edges
+            string invalid = n < 0 ? "Invalid number of vertices: " + to_string(n) + "\n" : "";
+            for (int i = 0; i < m; ++i) { // Loop to receive edges from the client
+                optional<string> line = co_await conn->readLine();
+                if (!line) {
+                    co_return; // Hung up in the middle of the upload
+                }
+                int u = 0, v = 0;
+                bool parsed = sscanf(line->c_str(), "%d %d", &u, &v) == 2; // Parse the edge
+                edges[i] = make_pair(u, v);
+                if (invalid.empty() && (!parsed || u < 1 || v < 1 || u > n || v > n)) {
+                    invalid = "Invalid edge: " + to_string(u) + " -> " + to_string(v) + "\n"; // Reported once the upload is over
+                }
+                response = "Edge " + to_string(i + 1) + ": " + to_string(u) + " -> " + to_string(v) + "\n";
+                co_await conn->write(response); // Send edge information back to client
+            }
+            if (!invalid.empty()) { // Nothing is built or logged: the graph would not fit its vertices
+                if (!co_await conn->write(invalid + "Graph not created\n")) {
+                    co_return;
+                }
+                continue;
+            }
+            auto build = [n, &edges]() { return createGraph(n, edges); }; // Named: the frame keeps edges alive
+            string created = co_await conn->offload(build);
+            if (!co_await conn->write(created)) {
+                co_return;
+            }
+        } else {
+            string response;
+            if (command->find("NewEdge") == 0 || command->find("RemoveEdge") == 0) {
+                response = processCommand(*command); // Only stages the update: cheaper than a hop to a worker
+            } else {
+                auto run = [&command]() { return processCommand(*command); };
+                response = co_await conn->offload(run);
+            }
+            if (!response.empty() && !co_await conn->write(response)) {
+                co_return; // The client is gone
+            }
+        }
+    }
+}
+
+/// Scheduler running the expensive commands of every client, whatever drives its socket
+void* commandScheduler = nullptr;
+/// io_uring proactor serving the clients in -u mode
+void* uringProactor = nullptr;
+/// Connections served by the io_uring proactor, indexed by socket
+vector<UringConnection*> uringConnections;
+
+/// @brief Handles a connected client.
+/// @param clientSocket The socket of the client.
+/// @return nullptr
+void* handleClient(int clientSocket) {
+    BlockingConnection conn(clientSocket);
+    conn.setScheduler(commandScheduler); // Commands run on the workers; results come back through wakeupFd()
+    clientSession(&conn); // Runs until it waits for the first line
+    char buffer[1024];
+    int nbytes = 1;
+    struct pollfd fds[2] = {{clientSocket, POLLIN, 0}, {conn.wakeupFd(), POLLIN, 0}};
+    int nfds = conn.wakeupFd() >= 0 ? 2 : 1;
+    while (nbytes > 0) {
+        if (poll(fds, nfds, -1) < 0) { // Wait for the client or for posted work (SCC events)
+            if (errno == EINTR) {
+                continue;
+            }
+            nbytes = -1;
+            break;
+        }
+        if (nfds == 2 && (fds[1].revents & POLLIN)) {
+            conn.runPosted();
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            nbytes = read(clientSocket, buffer, sizeof(buffer)); // Read data from client
+            if (nbytes > 0) {
+                conn.feed(buffer, nbytes); // Resumes the session for every complete line
+            }
+        }
+    }
+
+    if (nbytes == 0) {
+        cout << "Socket " << clientSocket << " hung up" << endl; // Log if the client disconnected
+    } else {
+        cerr << "Error on read" << endl; // Log read error
+    }
+    conn.hangUp(); // Lets the session finish
+    while (conn.isOffloading()) { // A command still runs on a worker: conn must outlive it
+        poll(&fds[1], 1, -1);
+        conn.runPosted();
+    }
+
+    close(clientSocket); // Close the socket
+    return nullptr;
+}
+
+/// @brief Called by the io_uring proactor for every accepted connection.
+/// @param clientSocket The socket of the client.
+/// @return nullptr
+void* acceptUringClient(int clientSocket) {
+    if (static_cast<size_t>(clientSocket) >= uringConnections.size()) {
+        uringConnections.resize(clientSocket + 1, nullptr);
+    }
+    UringConnection* conn = new UringConnection(clientSocket, uringProactor);
+    conn->setScheduler(commandScheduler); // Commands run on the workers, the proactor only does I/O
+    uringConnections[clientSocket] = conn;
+    cout << "New connection on socket " << clientSocket << endl; // Log new connection
+    clientSession(conn);
+    return nullptr;
+}
+
+/// @brief Called by the io_uring proactor when data from a client has arrived.
+/// @param clientSocket The socket of the client.
+/// @param data The received bytes.
+/// @param len Number of received bytes, 0 on hang up, negative on error.
+/// @return nullptr
+void* receiveUringClient(int clientSocket, const char* data, int len) {
+    UringConnection* conn = uringConnections[clientSocket];
+    if (len > 0) {
+        conn->feed(data, len);
+        return nullptr;
+    }
+    if (len == 0) {
+        cout << "Socket " << clientSocket << " hung up" << endl; // Log if the client disconnected
+    } else {
+        cerr << "Error on read" << endl; // Log read error
+    }
+    conn->hangUp();
+    conn->release(); // The proactor closes the socket itself
+    uringConnections[clientSocket] = nullptr;
+    return nullptr;
+}
+
+/// @brief Called by the io_uring proactor once everything queued on a client's socket has been sent.
+/// @param clientSocket The socket of the client.
+/// @return nullptr
+void* drainedUringClient(int clientSocket) {
+    if (static_cast<size_t>(clientSocket) < uringConnections.size() && uringConnections[clientSocket]) {
+        uringConnections[clientSocket]->onDrained(); // Released connections are gone from the table
+    }
+    return nullptr;
+}
+
+/// @brief Serves every client from one reactor thread, each as a coroutine session.
+/// @param serverSocket The listening socket.
+void runReactorServer(int serverSocket) {
+    void* reactor = startReactor();
+    addFdToReactor(reactor, serverSocket, [reactor](int fd) {
+        int clientSocket = accept(fd, nullptr, nullptr); // Accept new connection
+        if (clientSocket == -1) {
+            cerr << "Error on accept" << endl; // Log error if accept fails
+            return;
+        }
+        cout << "New connection on socket " << clientSocket << endl; // Log new connection
+        ReactorConnection* conn = new ReactorConnection(clientSocket, reactor);
+        conn->setScheduler(commandScheduler); // Commands run on the workers, the reactor only does I/O
+        if (addFdToReactor(reactor, clientSocket, [reactor, conn](int clientFd) {
+                if (conn->onReadable()) {
+                    return; // Still connected
+                }
+                cout << "Socket " << clientFd << " hung up" << endl; // Log if the client disconnected
+                conn->hangUp(); // Lets the session finish
+                removeFdFromReactor(reactor, clientFd);
+                conn->release(); // Closes the socket once no command of it is still running
+            }) < 0) {
+            cerr << "Socket " << clientSocket << " is beyond what select() can watch" << endl;
+            delete conn;
+            close(clientSocket);
+            return;
+        }
+        clientSession(conn); // Runs until it waits for the first line
+    });
+    reactorLoop(reactor);
 }
 
 /// @brief Monitoring thread function.
+/// Consumes the changes queued by the mutation paths without ever taking graphMutex: it
+/// reports the 50% condition and fans the change out to SCC event subscribers.
 /// @return nullptr
 void* monitorGraph(void*) {
-    unique_lock<mutex> lock(graphMutex);
+    bool conditionWasMet = false;
     while (true) {
-        graphCondVar.wait(lock, []{ return sccConditionMet != sccConditionWasMet; }); // Wait for SCC condition change
-        if (sccConditionMet) {
-            cout << "At Least 50% of the graph belongs to the same SCC\n";
-        } else {
-            cout << "At Least 50% of the graph no longer belongs to the same SCC\n";
+        unsigned long seen = monitorSignal.load(memory_order_acquire);
+        MonitorEvent event;
+        if (!monitorQueue.pop(event)) {
+            monitorSignal.wait(seen, memory_order_acquire); // Sleep until the next wakeMonitor()
+            continue;
+        }
+        if (event.change == SCC_NEW_GRAPH) {
+            conditionWasMet = false; // A new graph is reported afresh
         }
-        sccConditionWasMet = sccConditionMet; // Update the previous condition state
+        bool conditionMet = event.after.vertices > 0 && event.after.largest >= event.after.vertices / 2;
+        if (conditionMet != conditionWasMet) {
+            if (conditionMet) {
+                cout << "At Least 50% of the graph belongs to the same SCC\n";
+            } else {
+                cout << "At Least 50% of the graph no longer belongs to the same SCC\n";
+            }
+            conditionWasMet = conditionMet; // Update the previous condition state
+        }
+        publishSccChange(event.before, event.after, event.change);
     }
     return nullptr;
 }
 
-int main() {
+/// @brief Rebuilds the graph from the write-ahead log and keeps logging to it.
+/// Runs before any client or helper thread exists.
+/// @param dir The log directory.
+void recoverGraph(const char* dir) {
+    bool logging = recoverGraphLog(dir,
+        [](int n, const vector<pair<int, int>>& edges) {
+            for (const auto& edge : edges) {
+                if (n < 0 || edge.first < 1 || edge.second < 1 || edge.first > n || edge.second > n) {
+                    cerr << "Skipping a logged graph with an invalid edge: " << edge.first << " -> " << edge.second << endl;
+                    return; // Logged before NewGraph checked its edges; building it would corrupt memory
+                }
+            }
+            delete graph;
+            graph = new KosarajuVectorList(n, edges);
+        },
+        [](int u, int v, bool add) {
+            int n = graph ? graph->getNumVertices() : 0;
+            if (u < 1 || v < 1 || u > n || v > n) {
+                return; // Only applied updates are logged, so this means a damaged log
+            }
+            if (add) {
+                graph->addEdge(u, v);
+            } else {
+                graph->removeEdge(u, v);
+            }
+        });
+    if (!logging) {
+        cerr << "Running without a graph log" << endl;
+    }
+    if (graph) {
+        graphVertices.store(graph->getNumVertices(), memory_order_release);
+        recordSccChange(SccState{0, 0, 0}, SCC_NEW_GRAPH); // The monitor reports the recovered graph
+        cout << "Graph recovered with " << graph->getNumVertices() << " vertices" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     int serverSocket, clientSocket;
     struct sockaddr_in serverAddr, clientAddr;
     socklen_t addrLen = sizeof(clientAddr);
 
+    const char* mode = ""; // -u, -r or the default proactor threads
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) { // -w <dir>: log the graph there and recover it on start
+            recoverGraph(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) { // -d <dir>: the only files commands reach
+            string error;
+            if (!setDataDirectory(argv[++i], error)) {
+                cerr << "Invalid data directory: " << error << endl;
+                return 1;
+            }
+        } else {
+            mode = argv[i];
+        }
+    }
+
     serverSocket = socket(AF_INET, SOCK_STREAM, 0); // Create a socket
     if (serverSocket < 0) {
         cerr << "Error opening socket" << endl; // Log error if socket creation fails
@@ -213,6 +788,31 @@ int main() {
     pthread_t monitorThread;
     pthread_create(&monitorThread, nullptr, monitorGraph, nullptr);
 
+    // Start the thread applying staged edge updates
+    pthread_t applierThread;
+    pthread_create(&applierThread, nullptr, applyStagedEdges, nullptr);
+
+    commandScheduler = startScheduler(0); // One worker per core, shared by every mode
+
+    if (strcmp(mode, "-u") == 0) { // Serve every client from one io_uring completion loop
+        void* proactor = startUringProactor(serverSocket, acceptUringClient, receiveUringClient, drainedUringClient);
+        if (proactor) {
+            uringProactor = proactor;
+            cout << "Using the io_uring proactor" << endl;
+            uringProactorLoop(proactor);
+            stopScheduler(commandScheduler);
+            close(serverSocket);
+            return 0;
+        }
+        cerr << "Falling back to one proactor thread per client" << endl;
+    } else if (strcmp(mode, "-r") == 0) { // Serve every client from one reactor thread
+        cout << "Using the reactor with coroutine sessions" << endl;
+        runReactorServer(serverSocket);
+        stopScheduler(commandScheduler);
+        close(serverSocket);
+        return 0;
+    }
+
     while (true) {
         clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &addrLen); // Accept new connection
         if (clientSocket == -1) {
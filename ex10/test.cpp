@@ -0,0 +1,338 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "kosaraju_vector_list.hpp"
+#include "graph_wal.hpp"
+
+using namespace std;
+
+// Helper function to compare the SCCs kept up to date by addEdge()/removeEdge() with a fresh Kosaraju run
+bool compare_incremental(const KosarajuVectorList& graph) {
+    vector<vector<int>> expected = graph.snapshot().findSCCs();
+    const vector<int>& ids = graph.componentIds();
+    int largest = 0;
+    vector<int> sccOfId(graph.getNumVertices(), -1);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        largest = max(largest, static_cast<int>(expected[i].size()));
+        for (int v : expected[i]) {
+            if (ids[v] != ids[expected[i][0]]) {
+                cout << "Vertex " << v + 1 << " split from SCC " << i + 1 << endl;
+                return false;
+            }
+        }
+        int id = ids[expected[i][0]];
+        if (id < 0 || id >= graph.getNumVertices() || sccOfId[id] != -1) {
+            cout << "SCC " << i + 1 << " shares id " << id << " with another SCC" << endl;
+            return false;
+        }
+        sccOfId[id] = static_cast<int>(i);
+    }
+    if (graph.numComponents() != static_cast<int>(expected.size()) || graph.largestSCCSize() != largest) {
+        cout << "numComponents() = " << graph.numComponents() << ", expected " << expected.size() << endl;
+        cout << "largestSCCSize() = " << graph.largestSCCSize() << ", expected " << largest << endl;
+        return false;
+    }
+    return true;
+}
+
+// Random edges and removals, half of them of an existing edge so that SCCs also split
+bool test_incrementalSCCs() {
+    srand(7);
+    for (int trial = 0; trial < 500; ++trial) {
+        int n = 1 + rand() % 30;
+        vector<pair<int, int>> edges;
+        int m = rand() % (2 * n);
+        for (int i = 0; i < m; ++i) {
+            edges.push_back({1 + rand() % n, 1 + rand() % n});
+        }
+        KosarajuVectorList graph(n, edges);
+        if (!compare_incremental(graph)) {
+            cout << "Trial " << trial << ": mismatch after construction" << endl;
+            return false;
+        }
+        for (int step = 0; step < 200; ++step) {
+            int u = 1 + rand() % n;
+            int v = 1 + rand() % n;
+            if (rand() % 2 == 0) {
+                graph.addEdge(u, v);
+            } else {
+                GraphSnapshot snapshot = graph.snapshot();
+                const vector<int>& out = snapshot.neighbors(u - 1);
+                if (!out.empty()) {
+                    v = out[rand() % out.size()] + 1;
+                }
+                graph.removeEdge(u, v);
+            }
+            if (!compare_incremental(graph)) {
+                cout << "Trial " << trial << ", step " << step << ": mismatch after " << u << " -> " << v << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A mutation the server logs: a new graph if n > 0, else an edge update
+struct Mutation {
+    int n;
+    vector<pair<int, int>> edges;
+    int u;
+    int v;
+    bool add;
+};
+
+// Helper function to make random mutations of a graph with n vertices, starting with a new graph if n is 0
+vector<Mutation> randomMutations(int& n, int count) {
+    vector<Mutation> mutations;
+    if (n == 0) {
+        n = 20;
+        Mutation graph{n, {}, 0, 0, true};
+        for (int i = 0; i < 2 * n; ++i) {
+            graph.edges.push_back({1 + rand() % n, 1 + rand() % n});
+        }
+        mutations.push_back(graph);
+    }
+    for (int i = 0; i < count; ++i) {
+        mutations.push_back(Mutation{0, {}, 1 + rand() % n, 1 + rand() % n, rand() % 3 != 0});
+    }
+    return mutations;
+}
+
+// Helper function to apply mutations the way the server applies them and replays them
+void applyMutations(KosarajuVectorList*& graph, const vector<Mutation>& mutations, bool log) {
+    for (const Mutation& mutation : mutations) {
+        if (mutation.n > 0) {
+            delete graph;
+            graph = new KosarajuVectorList(mutation.n, mutation.edges);
+            if (log) {
+                logNewGraph(mutation.n, mutation.edges);
+            }
+        } else {
+            if (mutation.add) {
+                graph->addEdge(mutation.u, mutation.v);
+            } else {
+                graph->removeEdge(mutation.u, mutation.v);
+            }
+            if (log) {
+                logEdgeUpdate(mutation.u, mutation.v, mutation.add);
+            }
+        }
+    }
+}
+
+// Helper function to rebuild a graph from the log, like the server's recoverGraph()
+KosarajuVectorList* recoverFromLog(const string& dir) {
+    KosarajuVectorList* graph = nullptr;
+    recoverGraphLog(dir,
+        [&graph](int n, const vector<pair<int, int>>& edges) {
+            delete graph;
+            graph = new KosarajuVectorList(n, edges);
+        },
+        [&graph](int u, int v, bool add) {
+            if (add) {
+                graph->addEdge(u, v);
+            } else {
+                graph->removeEdge(u, v);
+            }
+        });
+    return graph;
+}
+
+// Helper function to compare two graphs edge by edge, whatever the order of the adjacency lists
+bool sameGraph(const KosarajuVectorList* graph, const KosarajuVectorList* expected) {
+    if (!graph || !expected || graph->getNumVertices() != expected->getNumVertices()) {
+        cout << "Vertex count mismatch" << endl;
+        return false;
+    }
+    vector<vector<int>> lists[2];
+    const KosarajuVectorList* graphs[2] = {graph, expected};
+    for (int g = 0; g < 2; ++g) {
+        GraphSnapshot snapshot = graphs[g]->snapshot();
+        for (int v = 0; v < snapshot.getNumVertices(); ++v) {
+            lists[g].push_back(snapshot.neighbors(v));
+            sort(lists[g].back().begin(), lists[g].back().end());
+        }
+    }
+    if (lists[0] != lists[1]) {
+        cout << "Edge mismatch" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Helper function to run a step in a child process: the log keeps its state in globals, and
+// each process may recover it only once. The child's exit is the crash that recovery follows.
+bool inChild(const function<bool()>& step) {
+    cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        bool ok = step();
+        cout.flush();
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Helper function to get the size of a file, -1 if it is missing
+long fileSize(const string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : -1;
+}
+
+// Helper function to remove the log directory and the files in it
+void removeDirectory(const string& dir) {
+    if (DIR* listing = opendir(dir.c_str())) {
+        while (struct dirent* entry = readdir(listing)) {
+            if (entry->d_name[0] != '.') {
+                unlink((dir + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(listing);
+    }
+    rmdir(dir.c_str());
+}
+
+// Damaged tails, then recovery from a checkpoint plus the segments logged around it
+bool test_graphLog() {
+    char dirTemplate[] = "/tmp/graph_wal_test.XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        cout << "Cannot create a log directory" << endl;
+        return false;
+    }
+    string dir = dirTemplate;
+    srand(11);
+    int n = 0;
+    KosarajuVectorList* expected = nullptr;
+    const long EDGE_RECORD = 20; // Type and length, u and v, checksum
+
+    // A log written and flushed, then a crash
+    vector<Mutation> logged = randomMutations(n, 40);
+    bool passed = inChild([&]() {
+        KosarajuVectorList* graph = recoverFromLog(dir);
+        applyMutations(graph, logged, true);
+        syncGraphLog();
+        return graph != nullptr;
+    });
+
+    // The last record torn: replay stops at the one before, which becomes the end of the segment
+    string segment = dir + "/wal.0";
+    long size = fileSize(segment);
+    passed = passed && truncate(segment.c_str(), size - 7) == 0;
+    applyMutations(expected, vector<Mutation>(logged.begin(), logged.end() - 1), false);
+    passed = passed && inChild([&]() {
+        KosarajuVectorList* graph = recoverFromLog(dir);
+        return sameGraph(graph, expected) && fileSize(segment) == size - EDGE_RECORD;
+    });
+    if (!passed) {
+        cout << "Recovery after a torn record failed" << endl;
+        return false;
+    }
+
+    // The last record garbled (a vertex changed): its checksum no longer matches
+    size = fileSize(segment);
+    int fd = open(segment.c_str(), O_RDWR);
+    char byte = 0;
+    passed = fd >= 0 && pread(fd, &byte, 1, size - 8) == 1;
+    byte ^= 0x40;
+    passed = passed && pwrite(fd, &byte, 1, size - 8) == 1;
+    if (fd >= 0) {
+        close(fd);
+    }
+    delete expected;
+    expected = nullptr;
+    applyMutations(expected, vector<Mutation>(logged.begin(), logged.end() - 2), false);
+    passed = passed && inChild([&]() {
+        KosarajuVectorList* graph = recoverFromLog(dir);
+        return sameGraph(graph, expected) && fileSize(segment) == size - EDGE_RECORD;
+    });
+    if (!passed) {
+        cout << "Recovery after a garbled record failed" << endl;
+        return false;
+    }
+
+    // A checkpoint taken between two segments, with updates logged while it is written
+    vector<Mutation> beforeCheckpoint = randomMutations(n, 30);
+    vector<Mutation> duringCheckpoint = randomMutations(n, 30);
+    vector<Mutation> afterCheckpoint = randomMutations(n, 30);
+    passed = inChild([&]() {
+        KosarajuVectorList* graph = recoverFromLog(dir);
+        if (!sameGraph(graph, expected)) {
+            return false;
+        }
+        applyMutations(graph, beforeCheckpoint, true);
+        long first = beginGraphCheckpoint(); // With graphMutex held in the server, like the snapshot
+        GraphSnapshot snapshot = graph->snapshot();
+        applyMutations(graph, duringCheckpoint, true);
+        writeGraphCheckpoint(first, &snapshot);
+        applyMutations(graph, afterCheckpoint, true);
+        syncGraphLog();
+        for (long old = 0; old < first; ++old) {
+            if (fileSize(dir + "/wal." + to_string(old)) >= 0) {
+                cout << "Segment " << old << " outlived the checkpoint" << endl;
+                return false;
+            }
+        }
+        return first > 0 && fileSize(dir + "/checkpoint") > 0;
+    });
+    applyMutations(expected, beforeCheckpoint, false);
+    applyMutations(expected, duringCheckpoint, false);
+    applyMutations(expected, afterCheckpoint, false);
+    passed = passed && inChild([&]() {
+        return sameGraph(recoverFromLog(dir), expected);
+    });
+    if (!passed) {
+        cout << "Recovery from a checkpoint failed" << endl;
+        return false;
+    }
+
+    // A crash after a new segment was started but before its checkpoint was written
+    vector<Mutation> beforeCrash = randomMutations(n, 30);
+    vector<Mutation> afterBegin = randomMutations(n, 30);
+    passed = inChild([&]() {
+        KosarajuVectorList* graph = recoverFromLog(dir);
+        applyMutations(graph, beforeCrash, true);
+        bool begun = beginGraphCheckpoint() > 0;
+        applyMutations(graph, afterBegin, true);
+        syncGraphLog();
+        return begun;
+    });
+    applyMutations(expected, beforeCrash, false);
+    applyMutations(expected, afterBegin, false);
+    passed = passed && inChild([&]() {
+        return sameGraph(recoverFromLog(dir), expected);
+    });
+    if (!passed) {
+        cout << "Recovery without the checkpoint of the last segment failed" << endl;
+        return false;
+    }
+
+    delete expected;
+    removeDirectory(dir);
+    return true;
+}
+
+int main() {
+    bool passed = true;
+    if (test_incrementalSCCs()) {
+        cout << "Incremental SCC Test Passed!" << endl;
+    } else {
+        cout << "Incremental SCC Test Failed!" << endl;
+        passed = false;
+    }
+    if (test_graphLog()) {
+        cout << "Graph Log Test Passed!" << endl;
+    } else {
+        cout << "Graph Log Test Failed!" << endl;
+        passed = false;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#ifndef TRANSITIVE_CLOSURE_HPP
+#define TRANSITIVE_CLOSURE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "kosaraju_vector_list.hpp"
+
+/*
+Transitive closure of the condensation DAG with word-packed bitsets.
+
+Row c of the closure is the set of components c reaches, c included. Components are numbered
+in topological order, so sweeping them from the highest id down means every successor's row is
+final before it is needed: a row is its own bit OR'ed with its successors' rows, 256 bits per
+vector operation.
+
+The whole matrix takes components^2 / 8 bytes, 1.25GB for 100k components. To stay within a
+memory limit the columns are computed in blocks: each block holds every row but only a slice
+of the columns, and is swept on its own. Rows above a block's last column are empty (nothing
+reaches a lower id), so each sweep starts there.
+*/
+
+/// @brief Receives the closure one column block at a time.
+/// @param firstColumn First component of the block.
+/// @param columns Number of components in the block.
+/// @param rows The rows, rowWords 64-bit words each; bit j of row c: c reaches firstColumn + j.
+/// @param rowWords Words per row.
+typedef std::function<void(int firstColumn, int columns, const uint64_t* rows, size_t rowWords)> ClosureBlockSink;
+
+/// @brief Computes the transitive closure of a condensation.
+/// @param dag The condensation (components in topological order).
+/// @param memoryLimit Bytes the bit rows of one block may take.
+/// @param sink Called with every block, or nullptr to only count.
+/// @param blocks Set to the number of column blocks used.
+/// @return Number of pairs of distinct components (a, b) where a reaches b.
+long transitiveClosure(const Condensation& dag, size_t memoryLimit, const ClosureBlockSink& sink, int& blocks);
+
+/// @brief Computes the transitive closure and writes it to a file.
+/// The file has a header (magic "KSTC\0\0\0\0", uint32 version, uint32 0, int64 components,
+/// int64 vertices), then one row of ceil(components / 64) 64-bit words per component, then the
+/// int32 component of every vertex.
+/// @param path Path of the file.
+/// @param dag The condensation.
+/// @param memoryLimit Bytes the bit rows of one block may take.
+/// @param pairs Set to the number of pairs of distinct components (a, b) where a reaches b.
+/// @param blocks Set to the number of column blocks used.
+/// @param error Set to the reason on failure.
+/// @return true on success.
+bool saveTransitiveClosure(const std::string& path, const Condensation& dag, size_t memoryLimit, long& pairs, int& blocks, std::string& error);
+
+#endif // TRANSITIVE_CLOSURE_HPP
@@ -0,0 +1,276 @@
+#include "edge_list_loader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../../common/numa_topology.hpp"
+
+using namespace std::chrono;
+
+static const size_t MIN_CHUNK_BYTES = 1 << 20;        // Smaller inputs are not worth another thread
+static const size_t PROGRESS_STEP = 16 << 20;         // Bytes a parser handles between progress updates
+static const size_t PROGRESS_MIN_BYTES = 64 << 20;    // Smaller inputs load too fast to report on
+static const size_t READ_BLOCK = 4 << 20;             // Block size when reading a pipe
+
+// Skips spaces, tabs and carriage returns.
+static const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+// Parses a non-negative decimal int. Returns nullptr if there is none or it overflows.
+static const char* parseInt(const char* p, const char* end, int& value) {
+    if (p == end || *p < '0' || *p > '9') {
+        return nullptr;
+    }
+    long long result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p++ - '0');
+        if (result > INT_MAX) {
+            return nullptr;
+        }
+    }
+    value = static_cast<int>(result);
+    return p;
+}
+
+// Parses one line holding two ints. Returns the start of the next line, or nullptr if malformed.
+// Sets parsed to false for blank and comment lines.
+static const char* parseLine(const char* p, const char* end, int& first, int& second, bool& parsed) {
+    parsed = false;
+    p = skipBlanks(p, end);
+    if (p < end && (*p == '#' || *p == '%')) {
+        const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+        return newline ? newline + 1 : end;
+    }
+    if (p == end || *p == '\n') {
+        return p == end ? end : p + 1;
+    }
+    if (!(p = parseInt(p, end, first)) || !(p = parseInt(skipBlanks(p, end), end, second))) {
+        return nullptr;
+    }
+    p = skipBlanks(p, end);
+    if (p < end && *p != '\n') {
+        return nullptr;
+    }
+    parsed = true;
+    return p == end ? end : p + 1;
+}
+
+// Line number (1-based) of an offset, for error messages.
+static size_t lineOf(const char* data, size_t offset) {
+    return count(data, data + offset, '\n') + 1;
+}
+
+// Reads the vertex count of a SNAP "# Nodes: N Edges: M" comment line. Returns false for any other line.
+static bool parseSnapNodes(const char* p, const char* lineEnd, int& nodes) {
+    static const char PREFIX[] = "# Nodes:";
+    const size_t length = sizeof(PREFIX) - 1;
+    if (static_cast<size_t>(lineEnd - p) < length || memcmp(p, PREFIX, length) != 0) {
+        return false;
+    }
+    return parseInt(skipBlanks(p + length, lineEnd), lineEnd, nodes) != nullptr;
+}
+
+// Parses a whole edge list held in memory.
+static bool parseEdgeList(const char* data, size_t size, int& n, vector<pair<int, int>>& edges, string& error, EdgeListStats& stats, ostream* progress) {
+    const char* end = data + size;
+
+    // Leading comments: a SNAP file announces itself with "# Nodes: N Edges: M" and has no header
+    const char* p = data;
+    bool snap = false;
+    int snapNodes = 0;
+    while (p < end) {
+        const char* q = skipBlanks(p, end);
+        const char* newline = q < end ? static_cast<const char*>(memchr(q, '\n', end - q)) : nullptr;
+        const char* lineEnd = newline ? newline : end;
+        if (q < lineEnd && *q != '#' && *q != '%') {
+            break;
+        }
+        snap = snap || parseSnapNodes(q, lineEnd, snapNodes);
+        p = newline ? newline + 1 : end;
+    }
+
+    // Header: the first line that is not blank or a comment
+    int m = 0;
+    bool parsed = snap;
+    while (p < end && !parsed) {
+        const char* next = parseLine(p, end, n, m, parsed);
+        if (!next) {
+            error = "line " + to_string(lineOf(data, p - data)) + ": expected the number of vertices and edges";
+            return false;
+        }
+        p = next;
+    }
+    if (!parsed) {
+        error = "missing the number of vertices and edges";
+        return false;
+    }
+
+    // One chunk per thread, each starting at the beginning of a line
+    size_t body = end - p;
+    size_t threads = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), body / MIN_CHUNK_BYTES));
+    vector<const char*> bounds(threads + 1, end);
+    bounds[0] = p;
+    for (size_t i = 1; i < threads; ++i) {
+        const char* split = p + body / threads * i;
+        const char* newline = static_cast<const char*>(memchr(split, '\n', end - split));
+        bounds[i] = max(bounds[i - 1], newline ? newline + 1 : end);
+    }
+
+    vector<vector<pair<int, int>>> parts(threads);
+    vector<size_t> errorOffsets(threads, SIZE_MAX);
+    vector<string> errors(threads);
+    vector<int> maxVertex(threads, 0); // Largest vertex of each chunk (SNAP input, where it gives n)
+    atomic<size_t> parsedBytes(0);
+    atomic<size_t> running(threads);
+    vector<thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.push_back(thread([&, i]() {
+            const char* q = bounds[i];
+            const char* chunkEnd = bounds[i + 1];
+            const char* reported = q;
+            vector<pair<int, int>>& part = parts[i];
+            part.reserve((chunkEnd - q) / 8); // A short edge line is about 8 bytes
+            while (q < chunkEnd) {
+                int u = 0, v = 0;
+                bool isEdge = false;
+                const char* next = parseLine(q, chunkEnd, u, v, isEdge);
+                if (!next) {
+                    errorOffsets[i] = q - data;
+                    errors[i] = "expected two vertex numbers";
+                    break;
+                }
+                if (isEdge && snap) { // 0-based: shift to the 1-based vertices of the graphs
+                    if (u == INT_MAX || v == INT_MAX) {
+                        errorOffsets[i] = q - data;
+                        errors[i] = "vertex " + to_string(max(u, v)) + " is too large";
+                        break;
+                    }
+                    ++u;
+                    ++v;
+                    maxVertex[i] = max(maxVertex[i], max(u, v));
+                } else if (isEdge && (u < 1 || v < 1 || u > n || v > n)) {
+                    errorOffsets[i] = q - data;
+                    errors[i] = "vertex " + to_string(u < 1 || u > n ? u : v) + " is outside 1.." + to_string(n);
+                    break;
+                }
+                if (isEdge) {
+                    part.push_back(make_pair(u, v));
+                }
+                q = next;
+                if (static_cast<size_t>(q - reported) >= PROGRESS_STEP) {
+                    parsedBytes += q - reported;
+                    reported = q;
+                }
+            }
+            parsedBytes += q - reported;
+            running--;
+        }));
+        // Consecutive chunks on the same node: each parser's edges are allocated next to it
+        pinThreadToNode(workers.back().native_handle(), NumaTopology::get().nodeOf(i, threads));
+    }
+    if (progress && size >= PROGRESS_MIN_BYTES) {
+        while (running.load() > 0) {
+            this_thread::sleep_for(milliseconds(250));
+            *progress << "Parsed " << (parsedBytes.load() >> 20) << " of " << (body >> 20) << " MB" << endl;
+        }
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    stats.threads = static_cast<int>(threads);
+
+    size_t first = min_element(errorOffsets.begin(), errorOffsets.end()) - errorOffsets.begin();
+    if (errorOffsets[first] != SIZE_MAX) {
+        error = "line " + to_string(lineOf(data, errorOffsets[first])) + ": " + errors[first];
+        return false;
+    }
+    size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    if (snap) { // Ids need not be dense: every id up to the largest is a vertex
+        n = max(snapNodes, *max_element(maxVertex.begin(), maxVertex.end()));
+        m = static_cast<int>(min<size_t>(total, INT_MAX));
+    }
+    if (total != static_cast<size_t>(m)) {
+        error = "the header announces " + to_string(m) + " edges but there are " + to_string(total);
+        return false;
+    }
+    edges.resize(total);
+    auto out = edges.begin();
+    for (auto& part : parts) {
+        out = copy(part.begin(), part.end(), out);
+        vector<pair<int, int>>().swap(part); // Release as we go: peak memory stays near 2x the edges
+    }
+    return true;
+}
+
+bool loadEdgeListFile(const string& path, int& n, vector<pair<int, int>>& edges, string& error, EdgeListStats& stats, ostream* progress) {
+    auto start = steady_clock::now();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0) { // Not mappable: read it instead
+        bool ok = loadEdgeListFd(fd, n, edges, error, stats, progress);
+        close(fd);
+        return ok;
+    }
+    size_t size = st.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file
+    if (data == MAP_FAILED) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    madvise(data, size, MADV_WILLNEED); // Every thread reads its chunk front to back
+    bool ok = parseEdgeList(static_cast<const char*>(data), size, n, edges, error, stats, progress);
+    munmap(data, size);
+    stats.bytes = size;
+    stats.seconds = duration<double>(steady_clock::now() - start).count();
+    if (!ok) {
+        error = path + ": " + error;
+    }
+    return ok;
+}
+
+bool loadEdgeListFd(int fd, int& n, vector<pair<int, int>>& edges, string& error, EdgeListStats& stats, ostream* progress) {
+    auto start = steady_clock::now();
+    vector<char> data;
+    size_t size = 0;
+    while (true) {
+        if (data.size() - size < READ_BLOCK) {
+            data.resize(max(data.size() * 2, size + READ_BLOCK));
+        }
+        ssize_t got = read(fd, data.data() + size, data.size() - size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            error = strerror(errno);
+            return false;
+        }
+        if (got == 0) {
+            break;
+        }
+        size += got;
+    }
+    bool ok = parseEdgeList(data.data(), size, n, edges, error, stats, progress);
+    stats.bytes = size;
+    stats.seconds = duration<double>(steady_clock::now() - start).count();
+    return ok;
+}
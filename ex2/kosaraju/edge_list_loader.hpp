@@ -0,0 +1,60 @@
+#ifndef EDGE_LIST_LOADER_HPP
+#define EDGE_LIST_LOADER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+/*
+Bulk loader for text edge lists in the format the mains read from cin:
+
+    n m
+    u1 v1
+    ...
+    um vm
+
+Reading this with cin >> and echoing every edge is bound by stream formatting and flushing
+long before the disk. The loader instead maps the file (or reads a pipe in large blocks),
+splits the edge lines into one chunk per hardware thread at line boundaries, and parses
+each chunk in parallel with a hand-rolled integer parser. Blank lines and lines starting
+with '#' or '%' (SNAP and Matrix Market comments) are skipped. Every vertex must lie in 1..n;
+the first one that does not fails the load with its line, as a syntax error does. On a machine
+with several NUMA nodes the parsers are pinned in contiguous groups, one per node.
+
+SNAP files are recognized by their "# Nodes: N Edges: M" comment before the first edge. They
+have no "n m" header and number the vertices from 0: the loader shifts every id by one and
+takes n as the larger of N and the largest id, so ids need not be dense. Without that comment
+the header is required.
+*/
+
+/// @brief Figures about one load, for instrumentation.
+struct EdgeListStats {
+    size_t bytes = 0;     ///< Size of the input.
+    int threads = 0;      ///< Parser threads used.
+    double seconds = 0.0; ///< Time from opening the input to having the edges.
+};
+
+/// @brief Loads an edge list from a file.
+/// @param path Path of the file.
+/// @param n Set to the number of vertices.
+/// @param edges Set to the edges (1-based), in file order.
+/// @param error Set to the reason on failure.
+/// @param stats Filled with the size, threads and time of the load.
+/// @param progress Stream to report progress on for large inputs, or nullptr.
+/// @return true on success.
+bool loadEdgeListFile(const string& path, int& n, vector<pair<int, int>>& edges, string& error, EdgeListStats& stats, ostream* progress = nullptr);
+
+/// @brief Loads an edge list from an open descriptor (a pipe or stdin), reading it to the end.
+/// @param fd The descriptor.
+/// @param n Set to the number of vertices.
+/// @param edges Set to the edges (1-based), in input order.
+/// @param error Set to the reason on failure.
+/// @param stats Filled with the size, threads and time of the load.
+/// @param progress Stream to report progress on for large inputs, or nullptr.
+/// @return true on success.
+bool loadEdgeListFd(int fd, int& n, vector<pair<int, int>>& edges, string& error, EdgeListStats& stats, ostream* progress = nullptr);
+
+#endif // EDGE_LIST_LOADER_HPP
@@ -1,8 +1,10 @@
 #include "kosaraju_list.hpp"
 
-KosarajuList::KosarajuList(int n, const vector<pair<int, int>>& edges) : n(n) {
-    graph.resize(n + 1);  // Resize the graph to hold n+1 nodes (1-based index)
-    transposedGraph.resize(n + 1);  // Resize the transposed graph
+KosarajuList::KosarajuList(int n, const vector<pair<int, int>>& edges)
+    : n(n), graph(ArenaAllocator<AdjacencyList>(&arena)), transposedGraph(ArenaAllocator<AdjacencyList>(&arena)),
+      visited(ArenaAllocator<bool>(&arena)), sccs(ArenaAllocator<Component>(&arena)) {
+    graph.resize(n + 1, AdjacencyList(ArenaAllocator<int>(&arena)));  // Resize the graph to hold n+1 nodes (1-based index)
+    transposedGraph.resize(n + 1, AdjacencyList(ArenaAllocator<int>(&arena)));  // Resize the transposed graph
     visited.resize(n + 1, false);  // Initialize visited vector with false
     for (const auto& edge : edges) {
         if (edge.first > 0 && edge.first <= n && edge.second > 0 && edge.second <= n) {
@@ -16,7 +18,7 @@ KosarajuList::KosarajuList(int n, const vector<pair<int, int>>& edges) : n(n) {
     }
 }
 
-const std::list<std::list<int>>& KosarajuList::getSCCs() const {
+const KosarajuList::Components& KosarajuList::getSCCs() const {
     return sccs;
 }
 
@@ -39,9 +41,8 @@ void KosarajuList::findSCCs() {
         finishStack.pop();  // Remove the top node from the stack
         auto itVisited = next(visited.begin(), node);
         if (!(*itVisited)) {
-            list<int> scc;  // Create a new list to store the SCC
-            dfsSecondPass(node, scc);  // Perform DFS to collect nodes in the SCC
-            sccs.push_back(scc);  // Add the SCC to the list of SCCs
+            sccs.emplace_back(ArenaAllocator<int>(&arena));  // Create a new list to store the SCC
+            dfsSecondPass(node, sccs.back());  // Perform DFS to collect nodes in the SCC
         }
     }
 }
@@ -71,7 +72,7 @@ void KosarajuList::dfsFirstPass(int node) {
     finishStack.push(node);  // Push the node onto the finish stack after visiting all its neighbors
 }
 
-void KosarajuList::dfsSecondPass(int node, list<int>& scc) {
+void KosarajuList::dfsSecondPass(int node, Component& scc) {
     auto itVisited = next(visited.begin(), node);
     *itVisited = true;  // Mark the node as visited
     scc.push_back(node);  // Add the node to the current SCC
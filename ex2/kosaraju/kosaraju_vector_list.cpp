@@ -1,10 +1,12 @@
 #include "kosaraju_vector_list.hpp"
 
-KosarajuVectorList::KosarajuVectorList(int n, const vector<pair<int, int>>& edges) : n(n) {
+KosarajuVectorList::KosarajuVectorList(int n, const vector<pair<int, int>>& edges)
+    : n(n), graph(ArenaAllocator<AdjacencyList>(&arena)), transposedGraph(ArenaAllocator<AdjacencyList>(&arena)),
+      sccs(ArenaAllocator<Component>(&arena)) {
     // Initialize the graph with n+1 nodes to accommodate 1-based indexing
-    graph.resize(n + 1);
+    graph.resize(n + 1, AdjacencyList(ArenaAllocator<int>(&arena)));
     // Initialize the transposed graph with n+1 nodes to accommodate 1-based indexing
-    transposedGraph.resize(n + 1);
+    transposedGraph.resize(n + 1, AdjacencyList(ArenaAllocator<int>(&arena)));
     // Initialize the visited vector with n+1 nodes to accommodate 1-based indexing
     visited.resize(n + 1, false);
     for (const auto& edge : edges) {
@@ -15,7 +17,7 @@ KosarajuVectorList::KosarajuVectorList(int n, const vector<pair<int, int>>& edge
     }
 }
 
-const std::vector<std::vector<int>>& KosarajuVectorList::getSCCs() const {
+const KosarajuVectorList::Components& KosarajuVectorList::getSCCs() const {
     return sccs;
 }
 
@@ -38,9 +40,8 @@ void KosarajuVectorList::findSCCs() {
         int node = finishStack.top();  // Get the top node from the finish stack
         finishStack.pop();  // Remove the top node from the stack
         if (!visited[node]) {
-            vector<int> scc;  // Create a new vector to store the SCC
-            dfsSecondPass(node, scc);  // Perform DFS to collect nodes in the SCC
-            sccs.push_back(scc);  // Add the SCC to the list of SCCs
+            sccs.emplace_back(ArenaAllocator<int>(&arena));  // Create a new vector to store the SCC
+            dfsSecondPass(node, sccs.back());  // Perform DFS to collect nodes in the SCC
         }
     }
 }
@@ -67,7 +68,7 @@ void KosarajuVectorList::dfsFirstPass(int node) {
     finishStack.push(node);  // Push the node onto the finish stack after visiting all its neighbors
 }
 
-void KosarajuVectorList::dfsSecondPass(int node, vector<int>& scc) {
+void KosarajuVectorList::dfsSecondPass(int node, Component& scc) {
     visited[node] = true;  // Mark the node as visited
     scc.push_back(node);  // Add the node to the current SCC
     for (int neighbor : transposedGraph[node]) {
@@ -6,18 +6,23 @@
 #include <stack>
 #include <vector>
 #include <algorithm>
+#include "../../ex1/graph_arena.hpp"
 
 using namespace std;
 
 /// @brief KosarajuVectorList class to implement Kosaraju's algorithm for finding SCCs using a vector of lists
 class KosarajuVectorList {
 public:
+    typedef list<int, ArenaAllocator<int>> AdjacencyList;  ///< Neighbors of one node
+    typedef vector<int, ArenaAllocator<int>> Component;  ///< Nodes of one SCC
+    typedef vector<Component, ArenaAllocator<Component>> Components;  ///< Every SCC, in the order found
+
     /// @brief Constructor to initialize the graph and transposed graph
     /// @param n The number of nodes in the graph
     /// @param edges The edges of the graph
     KosarajuVectorList(int n, const vector<pair<int, int>>& edges);
 
-    const std::vector<std::vector<int>>& getSCCs() const;
+    const Components& getSCCs() const;
 
     /// @brief Finds and stores the strongly connected components (SCCs) of the graph
     void findSCCs();
@@ -27,11 +32,12 @@ public:
 
 private:
     int n;  ///< Number of nodes
-    vector<list<int>> graph;  ///< Adjacency list of the graph
-    vector<list<int>> transposedGraph;  ///< Adjacency list of the transposed graph
+    GraphArena arena;  ///< Every container of the graph and its SCCs: no malloc()/free() per edge or SCC
+    vector<AdjacencyList, ArenaAllocator<AdjacencyList>> graph;  ///< Adjacency list of the graph
+    vector<AdjacencyList, ArenaAllocator<AdjacencyList>> transposedGraph;  ///< Adjacency list of the transposed graph
     vector<bool> visited;  ///< Visited flag for nodes
     stack<int> finishStack;  ///< Stack to store finish times of nodes
-    vector<vector<int>> sccs;  ///< List of strongly connected components
+    Components sccs;  ///< List of strongly connected components
 
     /// @brief Depth-first search for the first pass (filling finish stack)
     /// @param node The starting node for DFS
@@ -40,7 +46,7 @@ private:
     /// @brief Depth-first search for the second pass (collecting SCCs)
     /// @param node The starting node for DFS
     /// @param scc The vector to store the current SCC
-    void dfsSecondPass(int node, vector<int>& scc);
+    void dfsSecondPass(int node, Component& scc);
 };
 
 #endif // KOSARAJU_VECTOR_LIST_H
@@ -8,10 +8,14 @@
 #include "kosaraju_matrix.hpp"
 #include "kosaraju_vector_list.hpp"
 #include "../../ex1/kosaraju_linked_list.hpp"
+#include "edge_list_loader.hpp"
+#include <unistd.h>
 
 using namespace std;
 using namespace std::chrono; // for the time analysis
 
+const int ECHO_EDGE_LIMIT = 1000; ///< Graphs with more edges are not echoed edge by edge
+
 /// @brief Profiles the execution time of a given function.
 /// @tparam Func A callable type (e.g., function, lambda)
 /// @param name The name of the function being profiled
@@ -72,21 +76,30 @@ void run_kosaraju_vector_list(int n, const vector<pair<int, int>>& edges) {
     kosarajuVectorList.printSCCs();  // Print SCCs
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     cout << "Reading number of vertices and edges..." << endl;
 
-    // Read the number of vertices and edges
-    int n, m;
-    cin >> n >> m;
+    // Read the graph from the file given as argument, or from stdin, with the parallel loader
+    int n = 0;
+    vector<pair<int, int>> edges;
+    string error;
+    EdgeListStats stats;
+    bool loaded = argc > 1 ? loadEdgeListFile(argv[1], n, edges, error, stats, &cout)
+                           : loadEdgeListFd(STDIN_FILENO, n, edges, error, stats, &cout);
+    if (!loaded) {
+        cerr << "Error reading the graph: " << error << endl;
+        return 1;
+    }
+    int m = static_cast<int>(edges.size());
     cout << "Number of vertices: " << n << ", Number of edges: " << m << endl;
-    vector<pair<int, int>> edges(m);
-
-    cout << "Reading edges..." << endl;
-
-    // Read the edges
-    for (int i = 0; i < m; ++i) {
-        cin >> edges[i].first >> edges[i].second;
-        cout << "Edge " << i << ": " << edges[i].first << " -> " << edges[i].second << endl;
+    cout << "Read " << stats.bytes << " bytes with " << stats.threads << " threads in " << stats.seconds << " seconds\n";
+
+    // Echo the edges of small graphs only: for large ones printing would take longer than everything else
+    if (m <= ECHO_EDGE_LIMIT) {
+        cout << "Reading edges..." << endl;
+        for (int i = 0; i < m; ++i) {
+            cout << "Edge " << i << ": " << edges[i].first << " -> " << edges[i].second << '\n';
+        }
     }
 
     map<string, double> timings;  // Map to store timings of each implementation
@@ -12,7 +12,7 @@
 using namespace std;
 
 // Helper function to convert list to vector
-vector<int> listToVector(const list<int>& lst) {
+vector<int> listToVector(const KosarajuList::Component& lst) {
     return vector<int>(lst.begin(), lst.end());
 }
 
@@ -29,9 +29,9 @@ vector<int> linkedListToVector(const LinkedList& linkedList) {
 
 // Helper function to compare SCCs from different implementations
 bool compare_scc(const deque<deque<int>>& scc1,
-                 const list<list<int>>& scc2,
+                 const KosarajuList::Components& scc2,
                  const vector<vector<int>>& scc3,
-                 const vector<vector<int>>& scc4,
+                 const KosarajuVectorList::Components& scc4,
                  const vector<LinkedList>& scc5,
                  vector<vector<int>> expected_scc) {
     if (scc1.size() != expected_scc.size() || scc2.size() != expected_scc.size() ||
@@ -67,7 +67,7 @@ bool compare_scc(const deque<deque<int>>& scc1,
         vector<int> sorted_scc3 = *it3;
         sort(sorted_scc3.begin(), sorted_scc3.end());
 
-        vector<int> sorted_scc4 = *it4;
+        vector<int> sorted_scc4(it4->begin(), it4->end());
         sort(sorted_scc4.begin(), sorted_scc4.end());
 
         vector<int> sorted_scc5 = linkedListToVector(*it5);
@@ -4,97 +4,371 @@
 
 using namespace std;
 
-KosarajuVectorList::KosarajuVectorList(int n, const vector<pair<int, int>>& edges) : n(n) {
-    // Initialize the graph with n+1 nodes to accommodate 1-based indexing
-    graph.resize(n + 1);
-    // Initialize the transposed graph with n+1 nodes to accommodate 1-based indexing
-    transposedGraph.resize(n + 1);
-    // Initialize the visited vector with n+1 nodes to accommodate 1-based indexing
-    visited.resize(n + 1, false);
+bool parseVertexOrder(const string& name, VertexOrder& order) {
+    if (name == "input") {
+        order = VertexOrder::Input;
+    } else if (name == "bfs") {
+        order = VertexOrder::Bfs;
+    } else if (name == "rcm") {
+        order = VertexOrder::ReverseCuthillMcKee;
+    } else if (name == "degree") {
+        order = VertexOrder::Degree;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Returns the client vertex to put at each internal index (1-based like the vertices; index 0 unused)
+template <typename Index, typename Vertex>
+static vector<Index> layoutVertices(size_t n, const vector<pair<Vertex, Vertex>>& edges, VertexOrder order) {
+    // Undirected adjacency as one flat array: the neighbors of v are adjacent[start[v]] .. adjacent[start[v + 1] - 1]
+    vector<size_t> start(n + 2, 0);
+    for (const auto& edge : edges) {
+        start[edge.first + 1]++;
+        start[edge.second + 1]++;
+    }
+    for (size_t v = 1; v <= n + 1; ++v) {
+        start[v] += start[v - 1];
+    }
+    vector<Index> adjacent(start[n + 1]);
+    vector<size_t> next(start.begin(), start.end() - 1);
+    for (const auto& edge : edges) {
+        adjacent[next[edge.first]++] = static_cast<Index>(edge.second);
+        adjacent[next[edge.second]++] = static_cast<Index>(edge.first);
+    }
+    auto degree = [&](Index v) { return start[v + 1] - start[v]; };
+
+    vector<Index> vertices(n);
+    for (size_t v = 1; v <= n; ++v) {
+        vertices[v - 1] = static_cast<Index>(v);
+    }
+    vector<Index> layout(1, 0);
+    layout.reserve(n + 1);
+    if (order == VertexOrder::Degree) {
+        stable_sort(vertices.begin(), vertices.end(), [&](Index a, Index b) { return degree(a) > degree(b); });
+        layout.insert(layout.end(), vertices.begin(), vertices.end());
+        return layout;
+    }
+
+    // Breadth-first from every vertex not reached yet; Cuthill-McKee starts from low degrees and
+    // takes each vertex's new neighbors lowest degree first
+    bool rcm = order == VertexOrder::ReverseCuthillMcKee;
+    if (rcm) {
+        stable_sort(vertices.begin(), vertices.end(), [&](Index a, Index b) { return degree(a) < degree(b); });
+    }
+    vector<bool> placed(n + 1, false);
+    for (Index root : vertices) {
+        if (placed[root]) {
+            continue;
+        }
+        placed[root] = true;
+        layout.push_back(root);
+        for (size_t i = layout.size() - 1; i < layout.size(); ++i) {
+            size_t first = layout.size();
+            Index v = layout[i];
+            for (size_t k = start[v]; k < start[v + 1]; ++k) {
+                if (!placed[adjacent[k]]) {
+                    placed[adjacent[k]] = true;
+                    layout.push_back(adjacent[k]);
+                }
+            }
+            if (rcm) {
+                stable_sort(layout.begin() + first, layout.end(), [&](Index a, Index b) { return degree(a) < degree(b); });
+            }
+        }
+    }
+    if (rcm) {
+        reverse(layout.begin() + 1, layout.end());
+    }
+    return layout;
+}
+
+template <typename Index>
+template <typename Vertex>
+BasicKosarajuVectorList<Index>::BasicKosarajuVectorList(size_t n, const vector<pair<Vertex, Vertex>>& edges, VertexOrder order,
+                                                        NumaPlacement placement) : n(n), placement(placement) {
+    if (order != VertexOrder::Input) {
+        vertexAt = layoutVertices<Index>(n, edges, order);
+        position.resize(n + 1, 0);
+        for (size_t i = 1; i <= n; ++i) {
+            position[vertexAt[i]] = static_cast<Index>(i);
+        }
+    }
+    // Initialize the graph and the transposed graph with n+1 nodes to accommodate 1-based indexing
+    graph = static_cast<AdjacencyList*>(::operator new((n + 1) * sizeof(AdjacencyList)));
+    transposedGraph = static_cast<AdjacencyList*>(::operator new((n + 1) * sizeof(AdjacencyList)));
+    placeMemory(graph, n + 1, placement); // Before resetLists() first-touches them
+    placeMemory(transposedGraph, n + 1, placement);
+    resetLists();
+    sccOffsets.assign(1, 0); // No SCCs until findSCCs()
+    // Initialize the visit marks with n+1 nodes to accommodate 1-based indexing
+    visitMark.resize(n + 1, 0);
+    placeMemory(visitMark.data(), visitMark.size(), placement);
+    // Exact capacities: no growth slack, and no buffer left behind in the arena by a regrowth
+    outDegree.assign(n + 1, 0); // Scratch of trim() until the first findSCCs()
+    inDegree.assign(n + 1, 0);
+    for (const auto& edge : edges) {
+        outDegree[toInternal(edge.first)]++;
+        inDegree[toInternal(edge.second)]++;
+    }
+    for (size_t v = 1; v <= n; ++v) {
+        graph[v].reserve(outDegree[v]);
+        transposedGraph[v].reserve(inDegree[v]);
+    }
     for (const auto& edge : edges) {
+        Index u = toInternal(edge.first), v = toInternal(edge.second);
         // Add edge to the graph (convert to one-based index)
-        graph[edge.first].push_back(edge.second);
+        graph[u].push_back(v);
         // Add edge to the transposed graph (convert to one-based index)
-        transposedGraph[edge.second].push_back(edge.first);
+        transposedGraph[v].push_back(u);
+    }
+}
+
+template <typename Index>
+BasicKosarajuVectorList<Index>::~BasicKosarajuVectorList() {
+    destroyLists(); // The arenas go afterwards, with the members
+    ::operator delete(graph);
+    ::operator delete(transposedGraph);
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::destroyLists() {
+    for (size_t v = 0; v <= n; ++v) {
+        graph[v].~AdjacencyList(); // A small buffer only goes to the arena's free list
+        transposedGraph[v].~AdjacencyList();
+    }
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::resetLists() {
+    if (!arenas.empty()) { // Not the first call: lists too large for the arena blocks are on the heap
+        destroyLists();
+    }
+    // The old arenas take every small buffer with them
+    const NumaTopology& topology = NumaTopology::get();
+    int count = placement == NumaPlacement::Partition ? topology.numNodes() : 1;
+    arenas.clear();
+    for (int node = 0; node < count; ++node) {
+        arenas.emplace_back(new GraphArena(placement, node));
+    }
+    for (size_t v = 0; v <= n; ++v) { // Constructed over the old lists
+        ArenaAllocator<Index> allocator(arenas[count == 1 ? 0 : topology.nodeOf(v, n + 1)].get());
+        new (&graph[v]) AdjacencyList(allocator);
+        new (&transposedGraph[v]) AdjacencyList(allocator);
+    }
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::trim() {
+    // Edges between distinct vertices only: a self-loop does not make a vertex part of a cycle
+    inDegree.assign(n + 1, 0);
+    outDegree.assign(n + 1, 0);
+    trimmed.clear();
+    for (size_t i = 1; i <= n; ++i) {
+        Index v = static_cast<Index>(i);
+        forEachNeighbor(graph, compressedGraph, v, [&](Index neighbor) {
+            if (neighbor != v) {
+                outDegree[v]++;
+                inDegree[neighbor]++;
+            }
+        });
+    }
+    for (size_t i = 1; i <= n; ++i) {
+        Index v = static_cast<Index>(i);
+        if (inDegree[v] == 0 || outDegree[v] == 0) {
+            trimmed.push_back(v);
+            markVisited(v); // Marks it removed
+        }
+    }
+    // Removing a vertex lowers its neighbors' degrees, which may remove them in turn
+    for (size_t i = 0; i < trimmed.size(); ++i) {
+        Index v = trimmed[i];
+        forEachNeighbor(graph, compressedGraph, v, [&](Index neighbor) {
+            if (neighbor != v && !isVisited(neighbor) && --inDegree[neighbor] == 0) {
+                trimmed.push_back(neighbor);
+                markVisited(neighbor);
+            }
+        });
+        forEachNeighbor(transposedGraph, compressedTransposedGraph, v, [&](Index neighbor) {
+            if (neighbor != v && !isVisited(neighbor) && --outDegree[neighbor] == 0) {
+                trimmed.push_back(neighbor);
+                markVisited(neighbor);
+            }
+        });
     }
 }
 
-void KosarajuVectorList::findSCCs() {
-    sccs.clear(); // Clear the SCCs vector before finding SCCs
-    fill(visited.begin(), visited.end(), false); // Reset the visited vector
-    while (!finishStack.empty()) {
-        finishStack.pop(); // Clear the finish stack
+template <typename Index>
+void BasicKosarajuVectorList<Index>::addTrimmedSCC(Index v) {
+    sccIds[toClient(v)] = static_cast<Index>(numSCCs());
+    sccVertices.push_back(toClient(v));
+    sccOffsets.push_back(static_cast<Index>(sccVertices.size()));
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::findSCCs() {
+    // Clear the SCCs before finding SCCs; the arrays keep their capacity for the next run
+    sccVertices.clear();
+    sccVertices.reserve(n);
+    sccOffsets.assign(1, 0);
+    sccIds.assign(n + 1, static_cast<Index>(-1));
+    newVisitEpoch(); // Unvisits every node without touching them
+    finishOrder.clear();
+    finishOrder.reserve(n);
+
+    // Trimming: trivial SCCs need no DFS; they stay marked visited so both passes skip them
+    trim();
+    for (Index v : trimmed) { // Sources of the condensation come first, as Kosaraju finds them
+        if (inDegree[v] == 0) {
+            addTrimmedSCC(v);
+        }
     }
 
     // First Pass
-    for (int i = 1; i <= n; ++i) {
-        if (!visited[i]) {
-            dfsFirstPass(i); // Perform DFS to fill the finish stack
+    for (size_t i = 1; i <= n; ++i) {
+        if (!isVisited(static_cast<Index>(i))) {
+            dfsFirstPass(static_cast<Index>(i)); // Perform DFS to fill the finish stack
         }
     }
 
     // Second Pass
-    fill(visited.begin(), visited.end(), false); // Reset the visited vector
-    while (!finishStack.empty()) {
-        int node = finishStack.top();
-        finishStack.pop();
-        if (!visited[node]) {
-            vector<int> scc;
-            dfsSecondPass(node, scc); // Perform DFS to find SCCs
-            sccs.push_back(scc);
+    newVisitEpoch();
+    for (Index v : trimmed) {
+        markVisited(v);
+    }
+    for (auto it = finishOrder.rbegin(); it != finishOrder.rend(); ++it) { // Latest finishing node first
+        Index node = *it;
+        if (!isVisited(node)) {
+            dfsSecondPass(node); // Perform DFS to find SCCs
+            sccOffsets.push_back(static_cast<Index>(sccVertices.size()));
+        }
+    }
+    for (auto it = trimmed.rbegin(); it != trimmed.rend(); ++it) { // Then the sinks, each after what reaches it
+        if (inDegree[*it] != 0) {
+            addTrimmedSCC(*it);
         }
     }
 }
 
-void KosarajuVectorList::printSCCs() const {
+template <typename Index>
+void BasicKosarajuVectorList<Index>::printSCCs() const {
     cout << "\nKosaraju Vector List algorithm: Strongly Connected Components (SCCs):" << endl;
-    int sccCount = 1;
-    for (const auto& scc : sccs) {
-        cout << "SCC " << sccCount++ << ": ";
-        for (int node : scc) {
-            cout << node << " ";  // Output the node (already adjusted for 1-based index)
+    for (size_t i = 0; i < numSCCs(); ++i) {
+        cout << "SCC " << i + 1 << ": ";
+        for (Index node : getSCC(i)) {
+            cout << static_cast<uint64_t>(node) << " ";  // Output the node (already adjusted for 1-based index)
         }
         cout << endl << "----------------" << endl;
     }
 }
 
-void KosarajuVectorList::printGraph() const {
+template <typename Index>
+size_t BasicKosarajuVectorList<Index>::largestSCCSize() const {
+    size_t largest = 0;
+    for (size_t i = 0; i < numSCCs(); ++i) {
+        largest = max<size_t>(largest, sccOffsets[i + 1] - sccOffsets[i]);
+    }
+    return largest;
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::printGraph() const {
     cout << "\nCurrent Graph (Adjacency List):\n";
-    for (int i = 1; i <= n; ++i) {
+    for (size_t i = 1; i <= n; ++i) {
         cout << i << " -> ";
-        for (int neighbor : graph[i]) {
-            cout << neighbor << " ";
-        }
+        forEachNeighbor(graph, compressedGraph, toInternal(i), [&](Index neighbor) {
+            cout << static_cast<uint64_t>(toClient(neighbor)) << " ";
+        });
         cout << endl;
     }
 }
 
-void KosarajuVectorList::dfsFirstPass(int node) {
-    visited[node] = true; // Mark the node as visited
-    for (int neighbor : graph[node]) {
-        if (!visited[neighbor]) {
+template <typename Index>
+void BasicKosarajuVectorList<Index>::dfsFirstPass(Index node) {
+    markVisited(node); // Mark the node as visited
+    forEachNeighbor(graph, compressedGraph, node, [&](Index neighbor) {
+        if (!isVisited(neighbor)) {
             dfsFirstPass(neighbor); // Recursively visit all neighbors
         }
-    }
-    finishStack.push(node); // Push the node to the finish stack after all neighbors are visited
+    });
+    finishOrder.push_back(node); // Record the node as finished after all neighbors are visited
 }
 
-void KosarajuVectorList::dfsSecondPass(int node, vector<int>& scc) {
-    visited[node] = true; // Mark the node as visited
-    scc.push_back(node); // Add the node to the current SCC
-    for (int neighbor : transposedGraph[node]) {
-        if (!visited[neighbor]) {
-            dfsSecondPass(neighbor, scc); // Recursively visit all neighbors
+template <typename Index>
+void BasicKosarajuVectorList<Index>::dfsSecondPass(Index node) {
+    markVisited(node); // Mark the node as visited
+    sccIds[toClient(node)] = static_cast<Index>(numSCCs());
+    sccVertices.push_back(toClient(node)); // Add the node to the current SCC
+    forEachNeighbor(transposedGraph, compressedTransposedGraph, node, [&](Index neighbor) {
+        if (!isVisited(neighbor)) {
+            dfsSecondPass(neighbor); // Recursively visit all neighbors
         }
+    });
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::compress() {
+    if (compressed) {
+        return;
+    }
+    compressedGraph = CompressedAdjacency(graph, n + 1);
+    compressedTransposedGraph = CompressedAdjacency(transposedGraph, n + 1);
+    compressed = true;
+    resetLists(); // Release the lists
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::expand() {
+    for (size_t v = 1; v <= n; ++v) {
+        compressedGraph.forEach(v, [&](Index neighbor) { graph[v].push_back(neighbor); });
+        compressedTransposedGraph.forEach(v, [&](Index neighbor) { transposedGraph[v].push_back(neighbor); });
+    }
+    compressedGraph = CompressedAdjacency();
+    compressedTransposedGraph = CompressedAdjacency();
+    compressed = false;
+}
+
+template <typename Index>
+void BasicKosarajuVectorList<Index>::addEdge(size_t u, size_t v) {
+    if (compressed) {
+        expand();
     }
+    Index from = toInternal(u), to = toInternal(v);
+    graph[from].push_back(to); // Add edge to the graph
+    transposedGraph[to].push_back(from); // Add edge to the transposed graph
 }
 
-void KosarajuVectorList::addEdge(int u, int v) {
-    graph[u].push_back(v); // Add edge to the graph
-    transposedGraph[v].push_back(u); // Add edge to the transposed graph
+template <typename Index>
+void BasicKosarajuVectorList<Index>::removeEdge(size_t u, size_t v) {
+    if (compressed) {
+        expand();
+    }
+    Index from = toInternal(u), to = toInternal(v);
+    graph[from].erase(remove(graph[from].begin(), graph[from].end(), to), graph[from].end()); // Remove edge from the graph
+    transposedGraph[to].erase(remove(transposedGraph[to].begin(), transposedGraph[to].end(), from), transposedGraph[to].end()); // Remove edge from the transposed graph
 }
 
-void KosarajuVectorList::removeEdge(int u, int v) {
-    graph[u].erase(remove(graph[u].begin(), graph[u].end(), v), graph[u].end()); // Remove edge from the graph
-    transposedGraph[v].erase(remove(transposedGraph[v].begin(), transposedGraph[v].end(), u), transposedGraph[v].end()); // Remove edge from the transposed graph
+template <typename Vertex>
+SccGraph* newKosarajuGraph(size_t n, const vector<pair<Vertex, Vertex>>& edges, VertexOrder order, NumaPlacement placement) {
+    if (n <= UINT16_MAX) {
+        return new BasicKosarajuVectorList<uint16_t>(n, edges, order, placement);
+    }
+    if (n <= UINT32_MAX) {
+        return new BasicKosarajuVectorList<uint32_t>(n, edges, order, placement);
+    }
+    return new BasicKosarajuVectorList<uint64_t>(n, edges, order, placement);
 }
+
+// The id widths newKosarajuGraph() picks from, for the edge types the loaders produce
+template class BasicKosarajuVectorList<uint16_t>;
+template class BasicKosarajuVectorList<uint32_t>;
+template class BasicKosarajuVectorList<uint64_t>;
+template BasicKosarajuVectorList<uint16_t>::BasicKosarajuVectorList(size_t, const vector<pair<int, int>>&, VertexOrder, NumaPlacement);
+template BasicKosarajuVectorList<uint32_t>::BasicKosarajuVectorList(size_t, const vector<pair<int, int>>&, VertexOrder, NumaPlacement);
+template BasicKosarajuVectorList<uint64_t>::BasicKosarajuVectorList(size_t, const vector<pair<int, int>>&, VertexOrder, NumaPlacement);
+template BasicKosarajuVectorList<uint16_t>::BasicKosarajuVectorList(size_t, const vector<pair<uint64_t, uint64_t>>&, VertexOrder, NumaPlacement);
+template BasicKosarajuVectorList<uint32_t>::BasicKosarajuVectorList(size_t, const vector<pair<uint64_t, uint64_t>>&, VertexOrder, NumaPlacement);
+template BasicKosarajuVectorList<uint64_t>::BasicKosarajuVectorList(size_t, const vector<pair<uint64_t, uint64_t>>&, VertexOrder, NumaPlacement);
+template SccGraph* newKosarajuGraph(size_t, const vector<pair<int, int>>&, VertexOrder, NumaPlacement);
+template SccGraph* newKosarajuGraph(size_t, const vector<pair<uint64_t, uint64_t>>&, VertexOrder, NumaPlacement);
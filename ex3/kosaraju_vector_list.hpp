@@ -2,56 +2,304 @@
 #define KOSARAJU_VECTOR_LIST_H
 
 #include <iostream>
-#include <list>
-#include <stack>
+#include <string>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "../ex1/graph_arena.hpp"
 
 using namespace std;
 
-/// @brief Class implementing Kosaraju's algorithm using a vector of lists representation of the graph.
-class KosarajuVectorList {
+/// @brief Read-only view of the vertices of one SCC, valid until the next findSCCs().
+template <typename Index>
+class SccRange {
 public:
-    /// @brief Constructor to initialize the graph and transposed graph.
-    /// @param n The number of nodes in the graph.
-    /// @param edges The edges of the graph.
-    KosarajuVectorList(int n, const vector<pair<int, int>>& edges);
+    SccRange(const Index* first, const Index* last) : first(first), last(last) {}
+    const Index* begin() const { return first; }
+    const Index* end() const { return last; }
+    size_t size() const { return last - first; }
+
+private:
+    const Index* first;  ///< First vertex.
+    const Index* last;   ///< Past the last vertex.
+};
+
+/// @brief Read-only adjacency lists, each vertex's neighbors sorted and stored as gaps in
+/// variable-length bytes (7 bits per byte, high bit set on all but the last byte).
+/// Neighbors that are close in number, the common case after renumbering, take one byte instead
+/// of a list node of a few dozen.
+class CompressedAdjacency {
+public:
+    CompressedAdjacency() {}
+
+    /// @brief Encodes adjacency lists (vertices 1..count - 1).
+    /// @param lists The lists.
+    /// @param count Number of lists.
+    template <typename List>
+    CompressedAdjacency(const List* lists, size_t count) : offsets(count + 1, 0) {
+        vector<uint64_t> sorted;
+        for (size_t v = 0; v < count; ++v) {
+            offsets[v] = bytes.size();
+            sorted.assign(lists[v].begin(), lists[v].end());
+            sort(sorted.begin(), sorted.end());
+            uint64_t previous = 0;
+            for (uint64_t neighbor : sorted) {
+                uint64_t gap = neighbor - previous;
+                previous = neighbor;
+                while (gap >= 0x80) {
+                    bytes.push_back(static_cast<uint8_t>(gap | 0x80));
+                    gap >>= 7;
+                }
+                bytes.push_back(static_cast<uint8_t>(gap));
+            }
+        }
+        offsets[count] = bytes.size();
+        bytes.shrink_to_fit();
+    }
+
+    /// @brief Calls visit(neighbor) for every neighbor of a vertex, in increasing order.
+    /// @param v The vertex.
+    /// @param visit The callback.
+    template <typename Visit>
+    void forEach(size_t v, Visit visit) const {
+        const uint8_t* p = bytes.data() + offsets[v];
+        const uint8_t* end = bytes.data() + offsets[v + 1];
+        uint64_t neighbor = 0;
+        while (p < end) {
+            uint64_t gap = *p++;
+            if (gap >= 0x80) { // Rare multi-byte gap; single bytes skip the loop
+                gap &= 0x7f;
+                uint64_t byte;
+                int shift = 7;
+                do {
+                    byte = *p++;
+                    gap |= (byte & 0x7f) << shift;
+                    shift += 7;
+                } while (byte >= 0x80);
+            }
+            neighbor += gap;
+            visit(neighbor);
+        }
+    }
+
+    /// @brief Bytes taken by the encoded lists and their offsets.
+    size_t size() const { return bytes.size() + offsets.size() * sizeof(size_t); }
+
+private:
+    vector<size_t> offsets; ///< The neighbors of v are encoded in bytes[offsets[v]] .. bytes[offsets[v + 1] - 1].
+    vector<uint8_t> bytes;  ///< Encoded gaps of all vertices.
+};
+
+/// @brief Order in which the vertices are laid out in memory (see KosarajuVectorList).
+enum class VertexOrder {
+    Input,                ///< As numbered by the client.
+    Bfs,                  ///< Breadth-first, ignoring edge directions: neighbors get nearby indices.
+    ReverseCuthillMcKee,  ///< Like Bfs but from low-degree vertices, lowest degree first, reversed.
+    Degree                ///< Highest total degree first: the hubs most traversals touch share cache lines.
+};
+
+/// @brief Parses the name of a vertex order ("input", "bfs", "rcm" or "degree").
+/// @param name The name.
+/// @param order Set to the order on success.
+/// @return true if the name is known.
+bool parseVertexOrder(const string& name, VertexOrder& order);
+
+/// @brief A graph whose SCCs can be found, whatever the width of its vertex ids (see newKosarajuGraph()).
+/// Vertices are 1-based, as the clients number them.
+class SccGraph {
+public:
+    virtual ~SccGraph() {}
 
     /// @brief Finds and stores all Strongly Connected Components (SCCs) in the graph.
-    void findSCCs();
+    virtual void findSCCs() = 0;
 
     /// @brief Prints all the SCCs found in the graph.
-    void printSCCs() const;
+    virtual void printSCCs() const = 0;
+
+    /// @brief Number of SCCs found by the last findSCCs().
+    virtual size_t numSCCs() const = 0;
+
+    /// @brief Size of the largest SCC found by the last findSCCs() (0 before).
+    virtual size_t largestSCCSize() const = 0;
 
     /// @brief Adds an edge to the graph.
     /// @param u The starting node of the edge.
     /// @param v The ending node of the edge.
-    void addEdge(int u, int v);
+    virtual void addEdge(size_t u, size_t v) = 0;
 
     /// @brief Removes an edge from the graph.
     /// @param u The starting node of the edge.
     /// @param v The ending node of the edge.
-    void removeEdge(int u, int v);
+    virtual void removeEdge(size_t u, size_t v) = 0;
 
     /// @brief Prints the current state of the graph.
-    void printGraph() const; // for ex4, the users can create new graphs so we will know whats the current graph.
+    virtual void printGraph() const = 0; // for ex4, the users can create new graphs so we will know whats the current graph.
+
+    /// @brief Replaces the adjacency lists with their compressed form, which findSCCs() traverses
+    /// directly. Neighbors are then kept sorted. A later addEdge()/removeEdge() expands them again.
+    virtual void compress() = 0;
+
+    /// @brief Bytes taken by the compressed adjacency lists (0 unless compressed).
+    virtual size_t compressedSize() const = 0;
+
+    /// @brief Width of the vertex ids stored for every edge, in bits.
+    virtual int indexBits() const = 0;
+};
+
+/// @brief Class implementing Kosaraju's algorithm using a vector of lists representation of the graph.
+/// @tparam Index Unsigned type of the stored vertex ids (uint16_t, uint32_t or uint64_t); must hold n.
+/// Each vertex's neighbors are stored contiguously, sizeof(Index) bytes per edge and direction, so
+/// narrower ids shrink the adjacency as well as the SCC and scratch arrays.
+template <typename Index>
+class BasicKosarajuVectorList : public SccGraph {
+public:
+    /// @brief Neighbors of one vertex, held contiguously in the arena of its graph.
+    typedef vector<Index, ArenaAllocator<Index>> AdjacencyList;
+
+    /// @brief Constructor to initialize the graph and transposed graph.
+    /// @tparam Vertex Type of the vertices in edges (int or uint64_t).
+    /// @param n The number of nodes in the graph.
+    /// @param edges The edges of the graph.
+    /// @param order Vertex layout. Anything but Input renumbers the vertices internally so that
+    ///              the DFS passes touch nearby memory; every input and output keeps the client's ids.
+    /// @param placement NUMA placement of the lists and per-vertex arrays. Partition splits the
+    ///                  internal indices into one range per node.
+    template <typename Vertex>
+    BasicKosarajuVectorList(size_t n, const vector<pair<Vertex, Vertex>>& edges, VertexOrder order = VertexOrder::Input,
+                            NumaPlacement placement = NumaPlacement::FirstTouch);
+
+    /// @brief Releases the graph: small lists go with their arena blocks, only large ones are freed one by one.
+    ~BasicKosarajuVectorList();
+
+    BasicKosarajuVectorList(const BasicKosarajuVectorList&) = delete;
+    BasicKosarajuVectorList& operator=(const BasicKosarajuVectorList&) = delete;
+
+    void findSCCs() override;
+    void printSCCs() const override;
+    size_t numSCCs() const override { return sccOffsets.size() - 1; }
+    size_t largestSCCSize() const override;
+    void addEdge(size_t u, size_t v) override;
+    void removeEdge(size_t u, size_t v) override;
+    void printGraph() const override;
+    void compress() override;
+    size_t compressedSize() const override { return compressed ? compressedGraph.size() + compressedTransposedGraph.size() : 0; }
+    int indexBits() const override { return 8 * sizeof(Index); }
+
+    /// @brief Vertices of one SCC found by the last findSCCs().
+    /// @param i The SCC (0-based, below numSCCs()).
+    SccRange<Index> getSCC(size_t i) const { return SccRange<Index>(sccVertices.data() + sccOffsets[i], sccVertices.data() + sccOffsets[i + 1]); }
+
+    /// @brief SCC of a vertex, as found by the last findSCCs().
+    /// @param v The vertex (1-based).
+    Index sccOf(size_t v) const { return sccIds[v]; }
+
+    /// @brief Tells whether the adjacency lists are compressed.
+    bool isCompressed() const { return compressed; }
 
 private:
-    int n;  ///< Number of nodes in the graph.
-    vector<list<int>> graph;  ///< Adjacency list of the graph.
-    vector<list<int>> transposedGraph;  ///< Adjacency list of the transposed graph.
-    vector<bool> visited;  ///< Visited nodes for DFS.
-    stack<int> finishStack;  ///< Stack to store the finish times of nodes in the first pass of DFS.
-    vector<vector<int>> sccs;  ///< Vector to store the SCCs.
-
-    /// @brief Depth-First Search (DFS) for the first pass to fill the finish stack.
+    /// @brief Type of the degree counters: at least 32 bits, as multi-edges can outnumber the vertices.
+    typedef typename conditional<(sizeof(Index) > 4), uint64_t, uint32_t>::type Count;
+
+    size_t n;  ///< Number of nodes in the graph.
+    NumaPlacement placement;  ///< Placement of the lists and per-vertex arrays.
+    vector<unique_ptr<GraphArena>> arenas;  ///< Nodes of graph and transposedGraph (one arena per node with Partition).
+    AdjacencyList* graph;  ///< Adjacency list of the graph (n + 1 lists, sized exactly when built).
+    AdjacencyList* transposedGraph;  ///< Adjacency list of the transposed graph (like graph).
+    vector<uint8_t> visitMark;  ///< Epoch in which each node was last visited: visited means visitMark == epoch.
+    uint8_t epoch = 0;  ///< Current visit epoch; a new one unvisits every node, clearing visitMark only every 255 epochs.
+    vector<Index> finishOrder;  ///< Nodes in the order the first DFS pass finishes them (capacity kept across runs).
+    vector<Index> trimmed;  ///< Vertices removed by trim() (capacity kept across runs).
+    vector<Count> inDegree;  ///< Scratch of trim(): remaining in-degree of each node.
+    vector<Count> outDegree;  ///< Scratch of trim(): remaining out-degree of each node.
+    vector<Index> sccVertices;  ///< Vertices of every SCC (client ids), grouped by SCC.
+    vector<Index> sccOffsets;  ///< SCC i is sccVertices[sccOffsets[i]] .. sccVertices[sccOffsets[i + 1] - 1].
+    vector<Index> sccIds;  ///< SCC of each client vertex.
+    vector<Index> position;  ///< Internal index of each client vertex (empty for VertexOrder::Input).
+    vector<Index> vertexAt;  ///< Client vertex at each internal index (empty for VertexOrder::Input).
+    bool compressed = false;  ///< Whether the compressed lists replace graph and transposedGraph.
+    CompressedAdjacency compressedGraph;  ///< Compressed adjacency list of the graph.
+    CompressedAdjacency compressedTransposedGraph;  ///< Compressed adjacency list of the transposed graph.
+
+    /// @brief Internal index of a client vertex.
+    Index toInternal(size_t v) const { return position.empty() ? static_cast<Index>(v) : position[v]; }
+
+    /// @brief Client vertex at an internal index.
+    Index toClient(Index v) const { return vertexAt.empty() ? v : vertexAt[v]; }
+
+    /// @brief Starts a new visit epoch, in which no node is visited yet.
+    void newVisitEpoch() {
+        if (++epoch == 0) { // Wrapped around: old marks could match again (one O(n) clear per 255 passes)
+            fill(visitMark.begin(), visitMark.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    /// @brief Tells whether a node was visited in the current epoch.
+    bool isVisited(Index node) const { return visitMark[node] == epoch; }
+
+    /// @brief Marks a node visited in the current epoch.
+    void markVisited(Index node) { visitMark[node] = epoch; }
+
+    /// @brief Calls visit(neighbor) for every neighbor of node, from the lists or their compressed form.
+    template <typename Visit>
+    void forEachNeighbor(const AdjacencyList* lists, const CompressedAdjacency& packed, Index node, Visit visit) const {
+        if (compressed) {
+            packed.forEach(node, visit);
+        } else {
+            for (Index neighbor : lists[node]) {
+                visit(neighbor);
+            }
+        }
+    }
+
+    /// @brief Starts empty adjacency lists in a fresh arena, dropping the old lists with their
+    /// arena: O(n), and only lists too large for the arena's blocks are freed one by one.
+    void resetLists();
+
+    /// @brief Destroys the adjacency lists, whose small buffers simply stay in the arena.
+    void destroyLists();
+
+    /// @brief Turns the compressed lists back into graph and transposedGraph, for a modification.
+    void expand();
+
+    /// @brief Removes vertices with no in- or out-edges within the remaining graph, repeatedly.
+    /// Each is an SCC of its own; only the rest needs the DFS passes.
+    /// Fills trimmed and leaves them marked visited. A vertex removed for lack of in-edges keeps
+    /// inDegree 0, and all its predecessors were removed before it the same way; a vertex removed
+    /// for lack of out-edges has its successors removed before it. findSCCs() emits the first kind
+    /// in removal order before the core's SCCs and the second kind in reverse after them, so the
+    /// SCCs keep the topological order plain Kosaraju gives them.
+    void trim();
+
+    /// @brief Records a trimmed vertex as an SCC of its own.
+    /// @param v The vertex (internal index).
+    void addTrimmedSCC(Index v);
+
+    /// @brief Depth-First Search (DFS) for the first pass to fill the finish order.
     /// @param node The starting node for DFS.
-    void dfsFirstPass(int node);
+    void dfsFirstPass(Index node);
 
     /// @brief Depth-First Search (DFS) for the second pass to discover SCCs.
     /// @param node The starting node for DFS.
-    /// @param scc The current SCC being discovered.
-    void dfsSecondPass(int node, vector<int>& scc);
+    /// Appends its vertices to sccVertices.
+    void dfsSecondPass(Index node);
 };
 
+/// @brief The graph with 32-bit vertex ids, enough for most graphs.
+typedef BasicKosarajuVectorList<uint32_t> KosarajuVectorList;
+
+/// @brief Creates a graph with the narrowest vertex ids that hold n: 16 bits up to 65535 vertices,
+/// 32 bits up to 2^32 - 1, 64 bits beyond.
+/// @tparam Vertex Type of the vertices in edges (int or uint64_t).
+/// @param n The number of nodes in the graph.
+/// @param edges The edges of the graph.
+/// @param order Vertex layout (see BasicKosarajuVectorList).
+/// @param placement NUMA placement (see BasicKosarajuVectorList).
+/// @return The graph, to be deleted by the caller.
+template <typename Vertex>
+SccGraph* newKosarajuGraph(size_t n, const vector<pair<Vertex, Vertex>>& edges, VertexOrder order = VertexOrder::Input,
+                           NumaPlacement placement = NumaPlacement::FirstTouch);
+
 #endif // KOSARAJU_VECTOR_LIST_H
@@ -2,23 +2,54 @@
 #include <vector>
 #include <utility>
 #include "kosaraju_vector_list.hpp"
+#include "../ex2/kosaraju/edge_list_loader.hpp"
+#include <unistd.h>
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Usage: main [-o input|bfs|rcm|degree] [-p first|interleave|partition] [-c] [graph file]
+    VertexOrder order = VertexOrder::Input;
+    NumaPlacement placement = NumaPlacement::FirstTouch;
+    bool compress = false; // Compress the adjacency lists before finding the SCCs
+    int opt;
+    while ((opt = getopt(argc, argv, "o:p:c")) != -1) {
+        if (opt == 'c') {
+            compress = true;
+        } else if ((opt != 'o' || !parseVertexOrder(optarg, order)) && (opt != 'p' || !parseNumaPlacement(optarg, placement))) {
+            cerr << "Usage: " << argv[0] << " [-o input|bfs|rcm|degree] [-p first|interleave|partition] [-c] [graph file]" << endl;
+            return 1;
+        }
+    }
+
     cout << "Reading number of vertices and edges..." << endl;
     int n, m;
-    cin >> n >> m;
-    cout << "Number of vertices: " << n << ", Number of edges: " << m << endl;
-    vector<pair<int, int>> edges(m);
-
-    cout << "Reading edges..." << endl;
-    for (int i = 0; i < m; ++i) {
-        cin >> edges[i].first >> edges[i].second;
-        cout << "Edge " << i << ": " << edges[i].first << " -> " << edges[i].second << endl;
+    vector<pair<int, int>> edges;
+    if (optind < argc) { // Bulk load the graph from a file; stdin stays free for the questions below
+        string error;
+        EdgeListStats stats;
+        if (!loadEdgeListFile(argv[optind], n, edges, error, stats, &cout)) {
+            cerr << "Error reading the graph: " << error << endl;
+            return 1;
+        }
+        m = static_cast<int>(edges.size());
+        cout << "Number of vertices: " << n << ", Number of edges: " << m << endl;
+        cout << "Read " << stats.bytes << " bytes with " << stats.threads << " threads in " << stats.seconds << " seconds" << endl;
+    } else {
+        cin >> n >> m;
+        cout << "Number of vertices: " << n << ", Number of edges: " << m << endl;
+        edges.resize(m);
+
+        cout << "Reading edges..." << endl;
+        for (int i = 0; i < m; ++i) {
+            cin >> edges[i].first >> edges[i].second;
+            cout << "Edge " << i << ": " << edges[i].first << " -> " << edges[i].second << '\n'; // No flush per edge (cin flushes before reading)
+        }
     }
 
-    KosarajuVectorList kosaraju(n, edges);
+    unique_ptr<SccGraph> graph(newKosarajuGraph(n, edges, order, placement)); // Renumbered internally unless the order is "input"
+    SccGraph& kosaraju = *graph;
+    cout << "Vertex ids: " << kosaraju.indexBits() << " bits, NUMA nodes: " << NumaTopology::get().numNodes() << endl;
     
     char choice;
     while (true) {
@@ -49,6 +80,10 @@ int main() {
         }
     }
 
+    if (compress) {
+        kosaraju.compress();
+        cout << "Adjacency lists compressed to " << kosaraju.compressedSize() << " bytes" << endl;
+    }
     kosaraju.findSCCs();
     kosaraju.printSCCs();
     cout << "Done!" << endl;
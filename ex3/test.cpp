@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include "kosaraju_vector_list.hpp"
+
+using namespace std;
+
+// Helper function to compute the transitive closure by brute force: reach[u][v] if v is reachable from u
+vector<vector<bool>> transitiveClosure(size_t n, const vector<vector<bool>>& edge) {
+    vector<vector<bool>> reach = edge;
+    for (size_t v = 1; v <= n; ++v) {
+        reach[v][v] = true;
+    }
+    for (size_t k = 1; k <= n; ++k) {
+        for (size_t u = 1; u <= n; ++u) {
+            if (reach[u][k]) {
+                for (size_t v = 1; v <= n; ++v) {
+                    if (reach[k][v]) {
+                        reach[u][v] = true;
+                    }
+                }
+            }
+        }
+    }
+    return reach;
+}
+
+// Helper function to check the SCCs of the last findSCCs() against the closure: two vertices share
+// an SCC exactly when each reaches the other, and an SCC comes before every SCC it reaches
+template <typename Index>
+bool compare_closure(const BasicKosarajuVectorList<Index>& graph, size_t n, const vector<vector<bool>>& edge) {
+    vector<vector<bool>> reach = transitiveClosure(n, edge);
+    vector<size_t> sccOf(n + 1, graph.numSCCs());
+    size_t largest = 0;
+    for (size_t i = 0; i < graph.numSCCs(); ++i) {
+        largest = max(largest, graph.getSCC(i).size());
+        for (Index v : graph.getSCC(i)) {
+            if (v < 1 || v > n || sccOf[v] != graph.numSCCs() || graph.sccOf(v) != i) {
+                cout << "Vertex " << v << " misplaced in SCC " << i + 1 << endl;
+                return false;
+            }
+            sccOf[v] = i;
+        }
+    }
+    if (graph.largestSCCSize() != largest) {
+        cout << "largestSCCSize() = " << graph.largestSCCSize() << ", expected " << largest << endl;
+        return false;
+    }
+    for (size_t u = 1; u <= n; ++u) {
+        if (sccOf[u] == graph.numSCCs()) {
+            cout << "Vertex " << u << " is in no SCC" << endl;
+            return false;
+        }
+        for (size_t v = 1; v <= n; ++v) {
+            bool together = reach[u][v] && reach[v][u];
+            if (together != (sccOf[u] == sccOf[v])) {
+                cout << "Vertices " << u << " and " << v << (together ? " split" : " merged") << endl;
+                return false;
+            }
+            if (reach[u][v] && sccOf[u] > sccOf[v]) {
+                cout << "SCC of " << v << " comes before the SCC of " << u << ", which reaches it" << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Random graphs in one vertex order and id width, with edges added and removed between the runs
+template <typename Index>
+bool test_findSCCs(VertexOrder order, bool compressed) {
+    for (int trial = 0; trial < 100; ++trial) {
+        size_t n = 1 + rand() % 24;
+        vector<pair<int, int>> edges;
+        vector<vector<bool>> edge(n + 1, vector<bool>(n + 1, false));
+        size_t m = rand() % (2 * n + 1);
+        for (size_t i = 0; i < m; ++i) {
+            int u = 1 + rand() % n;
+            int v = 1 + rand() % n;
+            edges.push_back({u, v});
+            edge[u][v] = true;
+        }
+        BasicKosarajuVectorList<Index> graph(n, edges, order);
+        for (int run = 0; run < 8; ++run) {
+            if (compressed) {
+                graph.compress();
+            }
+            graph.findSCCs();
+            if (!compare_closure(graph, n, edge)) {
+                cout << "Trial " << trial << ", run " << run << ": " << 8 * sizeof(Index) << "-bit ids, order " << static_cast<int>(order)
+                     << (compressed ? ", compressed" : "") << endl;
+                return false;
+            }
+            for (int change = 0; change < 4; ++change) {
+                size_t u = 1 + rand() % n;
+                size_t v = 1 + rand() % n;
+                if (rand() % 2 == 0) {
+                    graph.addEdge(u, v);
+                    edge[u][v] = true;
+                } else {
+                    for (size_t next = 0; next < n && !edge[u][v]; ++next) {
+                        v = v % n + 1; // Prefer an edge that is there, so that SCCs split
+                    }
+                    graph.removeEdge(u, v); // Removes every copy of the edge
+                    edge[u][v] = false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    srand(45);
+    const VertexOrder orders[] = {VertexOrder::Input, VertexOrder::Bfs, VertexOrder::ReverseCuthillMcKee, VertexOrder::Degree};
+    bool passed = true;
+    for (VertexOrder order : orders) {
+        for (int compressed = 0; compressed < 2; ++compressed) {
+            passed = passed && test_findSCCs<uint16_t>(order, compressed);
+            passed = passed && test_findSCCs<uint32_t>(order, compressed);
+            passed = passed && test_findSCCs<uint64_t>(order, compressed);
+        }
+    }
+    if (passed) {
+        cout << "Kosaraju SCC and Topological Order Test Passed!" << endl;
+    } else {
+        cout << "Kosaraju SCC and Topological Order Test Failed!" << endl;
+    }
+    return passed ? 0 : 1;
+}
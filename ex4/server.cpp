@@ -21,7 +21,7 @@ using namespace std;
 mutex graphMutex;
 
 /// Pointer to the current graph
-KosarajuVectorList *graph = nullptr;
+SccGraph* graph = nullptr;
 
 /// @brief Processes commands received from the client.
 /// @param clientSocket The socket of the client.
@@ -53,7 +53,7 @@ void processCommand(int clientSocket, const string& command) {
         if (edgesToReceive == 0) { // Checks if all expected edges have been received.
             graphMutex.lock(); // Lock the graph mutex
             delete graph; // Delete the existing graph
-            graph = new KosarajuVectorList(edges.size(), edges); // Create a new graph
+            graph = newKosarajuGraph(edges.size(), edges); // Create a new graph, ids as narrow as its size allows
             graphMutex.unlock(); // Unlock the graph mutex
             response = "Graph created successfully with " + to_string(edges.size()) + " vertices and " + to_string(edges.size()) + " edges\n";
             write(clientSocket, response.c_str(), response.size()); // Send response to client
@@ -20,7 +20,7 @@ using namespace std;
 mutex graphMutex;
 
 /// Pointer to the current graph
-KosarajuVectorList* graph = nullptr;
+SccGraph* graph = nullptr;
 
 /// @brief Processes commands received from the client.
 /// @param clientSocket The socket of the client.
@@ -76,7 +76,7 @@ void processCommand(int clientSocket, const string& command) {
         
         graphMutex.lock(); // Lock the graph mutex
         delete graph; // Delete the existing graph
-        graph = new KosarajuVectorList(n, edges); // Create a new graph with the provided edges
+        graph = newKosarajuGraph(n, edges, VertexOrder::Input, NumaPlacement::Interleave); // Create a new graph with the provided edges, interleaved: client threads run on any node
         graphMutex.unlock(); // Unlock the graph mutex
         response = "Graph created successfully with " + to_string(n) + " vertices and " + to_string(m) + " edges\n";
         write(clientSocket, response.c_str(), response.size()); // Send confirmation to client
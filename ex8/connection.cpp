@@ -0,0 +1,309 @@
+#include "connection.hpp"
+#include "uring_proactor.hpp"
+#include "scheduler.hpp"
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <iostream>
+
+using namespace std;
+
+static const size_t CORK_LIMIT = 64 * 1024; // Replies held back while a read is being processed
+static const size_t URING_HIGH_WATER = 256 * 1024; // Queued bytes after which a UringConnection writer waits
+
+void SessionTask::promise_type::unhandled_exception() noexcept {
+    cerr << "Connection coroutine ended by an exception" << endl;
+}
+
+void Connection::feed(const char* data, size_t len) {
+    input.append(data, len);
+    if (reader && hasLine()) {
+        coroutine_handle<> handle = reader;
+        reader = nullptr;
+        handle.resume(); // Runs until the coroutine waits again (or finishes)
+    }
+}
+
+void Connection::hangUp() {
+    eof = true;
+    if (writer) {
+        writeDone(false); // The pending output can no longer be delivered
+    } else if (reader) {
+        coroutine_handle<> handle = reader;
+        reader = nullptr;
+        handle.resume(); // readLine() now yields the rest of the input, then std::nullopt
+    }
+}
+
+void Connection::writeDone(bool ok) {
+    if (!ok) {
+        broken = true;
+    }
+    if (writer) {
+        coroutine_handle<> handle = writer;
+        writer = nullptr;
+        handle.resume();
+    }
+}
+
+bool Connection::OffloadAwaiter::await_ready() {
+    if (conn.scheduler && conn.canPostBack()) {
+        return false;
+    }
+    result = work(); // Nowhere to post the result back to: run inline
+    return true;
+}
+
+void Connection::OffloadAwaiter::await_suspend(coroutine_handle<> handle) {
+    Connection* c = &conn;
+    c->offloading = true;
+    submitTask(c->scheduler, [this, c, handle]() {
+        result = work(); // The awaiter lives in the suspended coroutine frame
+        c->postBack([c, handle]() {
+            c->offloading = false;
+            handle.resume();
+            c->offloadDone(); // May free the connection
+        });
+    });
+}
+
+void Connection::push(string data) {
+    if (!broken) {
+        startWrite(data); // A waiting writer is resumed by writeDone() as usual
+    }
+}
+
+void Connection::whenDrained(function<void()> fn) {
+    if (pendingOutput() == 0) {
+        fn();
+        return;
+    }
+    drained = std::move(fn);
+}
+
+void Connection::outputDrained() {
+    if (drained) {
+        function<void()> fn = std::move(drained);
+        drained = nullptr;
+        fn();
+    }
+}
+
+optional<string> Connection::takeLine() {
+    size_t newline = input.find('\n', inputStart);
+    string line;
+    if (newline != string::npos) {
+        line = input.substr(inputStart, newline - inputStart);
+        inputStart = newline + 1;
+    } else if (inputStart < input.size()) {
+        line = input.substr(inputStart); // Unterminated last line before the hang up
+        inputStart = input.size();
+    } else {
+        return nullopt; // Hung up and nothing left to read
+    }
+    if (inputStart == input.size()) {
+        input.clear(); // Everything consumed: start over without copying
+        inputStart = 0;
+    } else if (inputStart > 4096 && inputStart * 2 > input.size()) {
+        input.erase(0, inputStart); // Reclaim the consumed prefix once it dominates the buffer
+        inputStart = 0;
+    }
+    return line;
+}
+
+ReactorConnection::ReactorConnection(int fd, void* reactor) : Connection(fd), reactor(reactor) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); // Never block the reactor thread
+}
+
+ReactorConnection::~ReactorConnection() {
+    if (waitingWritable) {
+        removeWriteFdFromReactor(reactor, fd);
+    }
+}
+
+void ReactorConnection::release() {
+    if (offloading) {
+        released = true; // offloadDone() finishes the job
+        return;
+    }
+    int clientFd = fd;
+    delete this;
+    close(clientFd); // Only now, so a new client cannot get the number while we may still write to it
+}
+
+bool ReactorConnection::postBack(function<void()> fn) {
+    return postToReactor(reactor, std::move(fn)) == 0;
+}
+
+void ReactorConnection::offloadDone() {
+    if (released && !offloading) {
+        release();
+    }
+}
+
+bool ReactorConnection::onReadable() {
+    char buffer[16384];
+    ssize_t nbytes = read(fd, buffer, sizeof(buffer));
+    if (nbytes > 0) {
+        corked = true; // Replies to all the lines of this read go out in one send
+        feed(buffer, static_cast<size_t>(nbytes));
+        corked = false;
+        if (!waitingWritable && !output.empty()) {
+            if (!flush()) {
+                broken = true;
+            } else if (!output.empty()) {
+                waitWritable();
+            }
+        }
+        return true;
+    }
+    return nbytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+}
+
+bool ReactorConnection::flush() {
+    while (outputStart < output.size()) {
+        ssize_t nbytes = send(fd, output.data() + outputStart, output.size() - outputStart, MSG_NOSIGNAL);
+        if (nbytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK; // Socket buffer full is not an error
+        }
+        outputStart += static_cast<size_t>(nbytes);
+    }
+    output.clear();
+    outputStart = 0;
+    return true;
+}
+
+bool ReactorConnection::startWrite(string& data) {
+    if (output.empty()) {
+        output.swap(data);
+    } else {
+        output += data;
+    }
+    if (waitingWritable) {
+        return false; // Already waiting for the socket: queue behind what is there
+    }
+    if (corked && output.size() - outputStart < CORK_LIMIT) {
+        return true; // onReadable() sends it with the other replies
+    }
+    if (!flush()) {
+        broken = true;
+        return true;
+    }
+    if (output.empty()) {
+        return true; // Everything went out without blocking
+    }
+    // The socket is full: resume the writer once the reactor has drained the rest
+    waitWritable();
+    return false;
+}
+
+void ReactorConnection::waitWritable() {
+    waitingWritable = true;
+    addWriteFdToReactor(reactor, fd, [this](int) {
+        bool ok = flush();
+        if (!ok || output.empty()) {
+            removeWriteFdFromReactor(reactor, fd);
+            waitingWritable = false;
+            writeDone(ok);
+            outputDrained();
+        }
+    });
+}
+
+BlockingConnection::BlockingConnection(int fd) : Connection(fd), wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (wakeFd < 0) {
+        cerr << "Error creating eventfd for socket " << fd << endl; // offload() then runs inline
+    }
+}
+
+BlockingConnection::~BlockingConnection() {
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+bool BlockingConnection::postBack(function<void()> fn) {
+    if (wakeFd < 0) {
+        return false;
+    }
+    {
+        lock_guard<mutex> lock(postedMutex);
+        posted.push_back(std::move(fn));
+    }
+    uint64_t one = 1;
+    return ::write(wakeFd, &one, sizeof(one)) == sizeof(one) || errno == EAGAIN; // EAGAIN: already signalled
+}
+
+void BlockingConnection::runPosted() {
+    uint64_t count;
+    if (::read(wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        cerr << "Error reading eventfd of socket " << fd << endl;
+    }
+    vector<function<void()>> batch;
+    {
+        lock_guard<mutex> lock(postedMutex);
+        batch.swap(posted);
+    }
+    for (function<void()>& fn : batch) {
+        fn();
+    }
+}
+
+bool BlockingConnection::startWrite(string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t nbytes = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (nbytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            broken = true;
+            break;
+        }
+        sent += static_cast<size_t>(nbytes);
+    }
+    return true;
+}
+
+bool UringConnection::startWrite(string& data) {
+    if (uringSend(proactor, fd, data.data(), data.size()) < 0) {
+        broken = true;
+        return true;
+    }
+    // The proactor owns a copy; ordering is kept by its linked sends. Past the high-water mark
+    // the writer waits for onDrained(), so a slow client cannot grow the queue without bound
+    return pendingOutput() < URING_HIGH_WATER;
+}
+
+size_t UringConnection::pendingOutput() const {
+    return uringPendingOutput(proactor, fd);
+}
+
+void UringConnection::onDrained() {
+    writeDone(true);
+    outputDrained();
+}
+
+void UringConnection::release() {
+    broken = true; // The socket number is no longer ours
+    if (offloading) {
+        released = true; // offloadDone() finishes the job
+        return;
+    }
+    delete this;
+}
+
+void UringConnection::offloadDone() {
+    if (released && !offloading) {
+        delete this;
+    }
+}
+
+bool UringConnection::postBack(function<void()> fn) {
+    return postToUringProactor(proactor, std::move(fn)) == 0;
+}
@@ -0,0 +1,264 @@
+#ifndef CONNECTION_HPP
+#define CONNECTION_HPP
+
+#include <string>
+#include <optional>
+#include <coroutine>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "reactor.hpp"
+
+/*
+Coroutine connection handlers (C++20).
+
+A client's protocol is written as one sequential coroutine:
+
+    SessionTask session(Connection* conn) {
+        while (auto line = co_await conn->readLine()) {
+            co_await conn->write("echo: " + *line + "\n");
+        }
+    }
+
+Instead of parking a thread in read(), the coroutine suspends and its frame (a few
+hundred bytes) is all that is kept per client. Whatever drives the socket - the reactor,
+the io_uring proactor or a plain blocking thread - pushes received bytes into the
+connection with feed(), which resumes the coroutine once a full line is available.
+
+Expensive work (an SCC computation, say) should not run on the thread driving the socket.
+With a scheduler attached, `co_await conn->offload(work)` runs work on a scheduler worker
+and resumes the coroutine back on the driving thread with the result.
+*/
+
+/// @brief Return type of a connection coroutine.
+/// The coroutine starts running immediately and frees its own frame when it finishes.
+struct SessionTask {
+    struct promise_type {
+        SessionTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+    };
+};
+
+/// @brief A client connection that coroutines can await lines from and write to.
+/// Subclasses decide how bytes leave the process (see startWrite()).
+class Connection {
+public:
+    /// @brief Awaiter returned by readLine().
+    struct LineAwaiter {
+        Connection& conn;
+        bool await_ready() const noexcept { return conn.hasLine() || conn.eof; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { conn.reader = handle; }
+        std::optional<std::string> await_resume() { return conn.takeLine(); }
+    };
+
+    /// @brief Awaiter returned by write().
+    struct WriteAwaiter {
+        Connection& conn;
+        std::string data;
+        bool await_ready() { return conn.broken || conn.startWrite(data); }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { conn.writer = handle; }
+        bool await_resume() const noexcept { return !conn.broken; }
+    };
+
+    /// @brief Awaiter returned by offload().
+    struct OffloadAwaiter {
+        Connection& conn;
+        std::function<std::string()> work;
+        std::string result;
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> handle);
+        std::string await_resume() { return std::move(result); }
+    };
+
+    /// @brief Creates a connection for a socket.
+    /// @param fd Socket of the client.
+    explicit Connection(int fd) : fd(fd) {}
+    virtual ~Connection() = default;
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// @brief Waits for the next line (without its trailing newline).
+    /// @return Awaiter yielding the line, or std::nullopt once the client has hung up.
+    LineAwaiter readLine() { return LineAwaiter{*this}; }
+
+    /// @brief Sends data, suspending while the socket cannot take it.
+    /// @param data Bytes to send.
+    /// @return Awaiter yielding false if the connection broke.
+    WriteAwaiter write(std::string data) { return WriteAwaiter{*this, std::move(data)}; }
+
+    /// @brief Runs work on the attached scheduler and resumes on the thread driving the connection.
+    /// Without a scheduler, or if the subclass cannot post back, work runs inline.
+    /// @param work Computation to run; must not touch the connection.
+    /// @return Awaiter yielding the result of work.
+    OffloadAwaiter offload(std::function<std::string()> work) { return OffloadAwaiter{*this, std::move(work), {}}; }
+
+    /// @brief Attaches a scheduler (see scheduler.hpp) used by offload().
+    void setScheduler(void* sched) { scheduler = sched; }
+
+    /// @brief Sends data without suspending, after everything written before it.
+    /// For output that is not a reply (pushed events); must run on the thread driving the connection.
+    /// @param data Bytes to send.
+    void push(std::string data);
+
+    /// @brief Bytes accepted by write()/push() that the socket has not taken yet.
+    virtual size_t pendingOutput() const { return 0; }
+
+    /// @brief Runs fn on the driving thread once pendingOutput() has dropped to 0 (right away if it is 0).
+    /// @param fn Callback; replaces one registered before.
+    void whenDrained(std::function<void()> fn);
+
+    /// @brief Whether postBack() is supported; offload() runs work inline otherwise.
+    virtual bool canPostBack() const { return false; }
+
+    /// @brief Runs fn on the thread driving the connection. Safe to call from any thread.
+    /// @return false if fn could not be posted.
+    virtual bool postBack(std::function<void()>) { return false; }
+
+    /// @brief Hands received bytes to the connection and resumes a waiting reader.
+    /// The coroutine may finish during this call; the caller still owns the connection.
+    /// @param data Received bytes.
+    /// @param len Number of bytes.
+    void feed(const char* data, size_t len);
+
+    /// @brief Marks the connection as closed by the peer and resumes whoever is waiting.
+    void hangUp();
+
+    /// @brief Socket of the client.
+    int socket() const { return fd; }
+
+    /// @brief Whether offload() work is still on the scheduler; the connection must outlive it.
+    bool isOffloading() const { return offloading; }
+
+protected:
+    /// @brief Starts sending data.
+    /// @param data Bytes to send; may be moved from.
+    /// @return true if the data has been handed off and the writer may continue right away,
+    ///         false if the writer must wait for writeDone().
+    virtual bool startWrite(std::string& data) = 0;
+
+    /// @brief Called by subclasses when a write that returned false from startWrite() has finished.
+    /// @param ok false if the connection broke.
+    void writeDone(bool ok);
+
+    /// @brief Called by subclasses once all pending output has been sent.
+    void outputDrained();
+
+    /// @brief Called on the driving thread after an offload() has resumed the coroutine.
+    virtual void offloadDone() {}
+
+    int fd;              ///< Socket of the client.
+    bool broken = false; ///< Set once writing has failed.
+    bool offloading = false; ///< True while offload() work is on the scheduler.
+
+private:
+    bool hasLine() const { return input.find('\n', inputStart) != std::string::npos; }
+    std::optional<std::string> takeLine();
+
+    std::string input;          ///< Received bytes not yet returned by readLine().
+    size_t inputStart = 0;      ///< Offset of the first unread byte in input.
+    bool eof = false;           ///< Set once the peer has hung up.
+    std::coroutine_handle<> reader; ///< Coroutine waiting in readLine(), if any.
+    std::coroutine_handle<> writer; ///< Coroutine waiting in write(), if any.
+    void* scheduler = nullptr;      ///< Scheduler used by offload(), if any.
+    std::function<void()> drained;  ///< Callback registered by whenDrained().
+};
+
+/// @brief Connection driven by the reactor: reads on readability, and writes that would block
+/// wait for writability instead of stalling the loop.
+class ReactorConnection : public Connection {
+public:
+    /// @param fd Socket of the client (switched to non-blocking mode).
+    /// @param reactor Reactor the socket is registered with.
+    ReactorConnection(int fd, void* reactor);
+    ~ReactorConnection() override;
+
+    /// @brief Reads whatever is available and feeds it to the coroutine.
+    /// @return false once the peer has hung up or the read failed.
+    bool onReadable();
+
+    /// @brief Closes the socket and frees the connection, or, while offload() work is still
+    /// running, does so as soon as it has come back. The socket must already be off the reactor.
+    void release();
+
+    size_t pendingOutput() const override { return output.size() - outputStart; }
+    bool canPostBack() const override { return true; }
+    bool postBack(std::function<void()> fn) override;
+
+protected:
+    bool startWrite(std::string& data) override;
+    void offloadDone() override;
+
+private:
+    bool flush(); ///< Writes as much pending output as the socket takes; false on error.
+    void waitWritable(); ///< Registers the write handler that drains output.
+
+    void* reactor;          ///< Reactor driving the socket.
+    std::string output;     ///< Bytes accepted by write() but not yet sent.
+    size_t outputStart = 0; ///< Offset of the first unsent byte in output.
+    bool waitingWritable = false; ///< True while a write handler is registered.
+    bool released = false;        ///< Set by release() while offload() work is still running.
+    bool corked = false;          ///< True while onReadable() feeds input; small writes are held back.
+};
+
+/// @brief Connection driven by a thread of its own; writes block.
+/// The thread waits for the socket and for wakeupFd() together, and calls runPosted() when
+/// the latter is readable so postBack() can reach it.
+class BlockingConnection : public Connection {
+public:
+    /// @param fd Socket of the client.
+    explicit BlockingConnection(int fd);
+    ~BlockingConnection() override;
+
+    /// @brief eventfd that becomes readable when callbacks have been posted.
+    int wakeupFd() const { return wakeFd; }
+
+    /// @brief Runs the callbacks posted so far. Call on the driving thread.
+    void runPosted();
+
+    bool canPostBack() const override { return wakeFd >= 0; }
+    bool postBack(std::function<void()> fn) override;
+
+protected:
+    bool startWrite(std::string& data) override;
+
+private:
+    int wakeFd;                                   ///< eventfd signalled by postBack().
+    std::mutex postedMutex;                       ///< Protects posted.
+    std::vector<std::function<void()>> posted;    ///< Callbacks waiting for runPosted().
+};
+
+/// @brief Connection driven by the io_uring proactor; writes are queued as linked sends.
+/// A writer waits once the queued bytes pass a high-water mark, as with ReactorConnection.
+class UringConnection : public Connection {
+public:
+    /// @param fd Socket of the client.
+    /// @param proactor io_uring proactor serving the socket.
+    UringConnection(int fd, void* proactor) : Connection(fd), proactor(proactor) {}
+
+    /// @brief Frees the connection once the proactor has reported its end, or, while offload()
+    /// work is still running, as soon as it has come back. Nothing is sent from then on: the
+    /// proactor may already have handed the socket number to a new client.
+    void release();
+
+    /// @brief Called by the proactor's drained handler once every queued send has completed:
+    /// resumes a writer held back by startWrite() and runs the whenDrained() callback.
+    void onDrained();
+
+    size_t pendingOutput() const override;
+    bool canPostBack() const override { return true; }
+    bool postBack(std::function<void()> fn) override;
+
+protected:
+    bool startWrite(std::string& data) override;
+    void offloadDone() override;
+
+private:
+    void* proactor; ///< Proactor serving the socket.
+    bool released = false; ///< Set by release() while offload() work is still running.
+};
+
+#endif // CONNECTION_HPP
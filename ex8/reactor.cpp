@@ -2,62 +2,231 @@
 #include <unistd.h>
 #include <iostream>
 #include <cstring> // For memset
+#include <cerrno>
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <sched.h>
 
 using namespace std;
 
+// Runs every task currently in the queue on the reactor thread.
+static void runPostedTasks(Reactor* reactor) {
+    reactorTask task;
+    while (reactor->tasks.pop(task)) {
+        task(); // Run the posted closure
+        task = nullptr; // Release its captures now, not when the next task is popped
+    }
+}
+
+// True when the caller may touch the reactor's fd sets and handlers directly.
+static bool onReactorThread(Reactor* reactor) {
+    return !reactor->inLoop.load(memory_order_acquire) || pthread_equal(reactor->loopThread, pthread_self());
+}
+
+// Runs the handler registered for fd in one of the handler tables. The handler may remove
+// or replace its own registration; the slot's generation tells us afterwards whether it did.
+static void dispatch(Reactor* reactor, vector<ReactorSlot>& table, int fd) {
+    ReactorSlot& slot = table[fd];
+    if (!slot.active) {
+        return; // Stale readiness for a descriptor removed earlier in this iteration
+    }
+    unsigned generation = slot.generation;
+    reactor->dispatchingTable = &table;
+    reactor->dispatchingFd = fd;
+    slot.func(fd); // Call the handler associated with the file descriptor
+    reactor->dispatchingTable = nullptr;
+    reactor->dispatchingFd = -1;
+    if (slot.generation != generation) {
+        if (slot.active) {
+            slot.func = std::move(reactor->deferredFunc); // Re-registered while running
+        } else {
+            slot.func.reset(); // Removed while running
+        }
+        reactor->deferredFunc.reset();
+    }
+}
+
+// Recomputes the highest descriptor watched for reading or writing.
+static void updateFdMax(Reactor* reactor) {
+    while (reactor->fdMax > 0 && !FD_ISSET(reactor->fdMax, &reactor->masterSet) &&
+           !FD_ISSET(reactor->fdMax, &reactor->writeMasterSet)) {
+        --reactor->fdMax;
+    }
+}
+
+// Stores func in the fd's slot of a handler table and starts watching the fd in master.
+static void registerHandler(Reactor* reactor, vector<ReactorSlot>& table, fd_set* master, int fd, reactorFunc& func) {
+    FD_SET(fd, master); // Add the file descriptor to the master set
+    if (fd > reactor->fdMax) {
+        reactor->fdMax = fd; // Update the maximum file descriptor value if needed
+    }
+    ReactorSlot& slot = table[fd];
+    if (&table == reactor->dispatchingTable && fd == reactor->dispatchingFd) {
+        reactor->deferredFunc = std::move(func); // The old handler is still executing; swap it in afterwards
+    } else {
+        slot.func = std::move(func); // Store the handler in the descriptor's slot
+    }
+    slot.active = true;
+    ++slot.generation;
+}
+
+// Clears the fd's slot of a handler table and stops watching the fd in master and pending.
+static void unregisterHandler(Reactor* reactor, vector<ReactorSlot>& table, fd_set* master, fd_set* pending, int fd) {
+    FD_CLR(fd, master); // Remove the file descriptor from the master set
+    FD_CLR(fd, pending); // Do not dispatch it later in the current iteration
+    ReactorSlot& slot = table[fd];
+    if (!slot.active) {
+        return;
+    }
+    slot.active = false;
+    ++slot.generation;
+    if (&table == reactor->dispatchingTable && fd == reactor->dispatchingFd) {
+        reactor->deferredFunc.reset(); // The running handler is released once it returns
+    } else {
+        slot.func.reset(); // Release the handler associated with the file descriptor
+    }
+    if (fd == reactor->fdMax) {
+        updateFdMax(reactor);
+    }
+}
+
 void* startReactor() {
     Reactor* reactor = new Reactor();
     FD_ZERO(&reactor->masterSet); // Initialize master set of file descriptors
     FD_ZERO(&reactor->readSet); // Initialize read set for select
+    FD_ZERO(&reactor->writeMasterSet); // Nothing waits for writability yet
+    FD_ZERO(&reactor->writeSet);
     reactor->fdMax = 0; // Initialize the maximum file descriptor value
     reactor->running = true; // Set running flag to true
+    reactor->inLoop = false;
+    reactor->producers = 0;
+    reactor->handlers.resize(FD_SETSIZE); // Never resized again, so slots stay put while their handlers run
+    reactor->writeHandlers.resize(FD_SETSIZE);
+    reactor->dispatchingTable = nullptr;
+    reactor->dispatchingFd = -1;
+
+    reactor->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); // Counter used to interrupt select()
+    if (reactor->wakeFd < 0) {
+        cerr << "Error creating reactor eventfd" << endl;
+        delete reactor;
+        return nullptr;
+    }
+    addFdToReactor(reactor, reactor->wakeFd, [reactor](int fd) {
+        uint64_t count;
+        while (read(fd, &count, sizeof(count)) > 0) {
+            // Drain the counter so select() blocks again
+        }
+        runPostedTasks(reactor);
+    });
     return reactor;
 }
 
 int addFdToReactor(void* reactorPtr, int fd, reactorFunc func) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
-    FD_SET(fd, &reactor->masterSet); // Add the file descriptor to the master set
-    if (fd > reactor->fdMax) {
-        reactor->fdMax = fd; // Update the maximum file descriptor value if needed
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1; // select() cannot watch this descriptor
+    }
+    if (!onReactorThread(reactor)) {
+        // Apply the registration on the reactor thread so the handler table is never shared
+        return postToReactor(reactor, [reactor, fd, func]() { addFdToReactor(reactor, fd, func); });
+    }
+    registerHandler(reactor, reactor->handlers, &reactor->masterSet, fd, func);
+    return 0;
+}
+
+int addWriteFdToReactor(void* reactorPtr, int fd, reactorFunc func) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;
+    }
+    if (!onReactorThread(reactor)) {
+        return postToReactor(reactor, [reactor, fd, func]() { addWriteFdToReactor(reactor, fd, func); });
     }
-    reactor->handlers[fd] = func; // Map the file descriptor to its handler function
+    registerHandler(reactor, reactor->writeHandlers, &reactor->writeMasterSet, fd, func);
     return 0;
 }
 
 int removeFdFromReactor(void* reactorPtr, int fd) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
-    FD_CLR(fd, &reactor->masterSet); // Remove the file descriptor from the master set
-    reactor->handlers.erase(fd); // Erase the handler associated with the file descriptor
-    if (fd == reactor->fdMax) {
-        // Update the maximum file descriptor value
-        while (!FD_ISSET(reactor->fdMax, &reactor->masterSet) && reactor->fdMax > 0) {
-            --reactor->fdMax;
-        }
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;
     }
+    if (!onReactorThread(reactor)) {
+        return postToReactor(reactor, [reactor, fd]() { removeFdFromReactor(reactor, fd); });
+    }
+    unregisterHandler(reactor, reactor->handlers, &reactor->masterSet, &reactor->readSet, fd);
     return 0;
 }
 
+int removeWriteFdFromReactor(void* reactorPtr, int fd) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;
+    }
+    if (!onReactorThread(reactor)) {
+        return postToReactor(reactor, [reactor, fd]() { removeWriteFdFromReactor(reactor, fd); });
+    }
+    unregisterHandler(reactor, reactor->writeHandlers, &reactor->writeMasterSet, &reactor->writeSet, fd);
+    return 0;
+}
+
+int wakeReactor(void* reactorPtr) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    uint64_t one = 1;
+    if (write(reactor->wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) { // EAGAIN: counter already saturated, loop is awake
+        return -1;
+    }
+    return 0;
+}
+
+int postToReactor(void* reactorPtr, reactorTask task) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    reactor->producers++; // Keep the loop from freeing the reactor under us
+    reactor->tasks.push(std::move(task));
+    int result = wakeReactor(reactor); // Make sure the loop notices the new task
+    reactor->producers--;
+    return result;
+}
+
 int stopReactor(void* reactorPtr) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    reactor->producers++;
     reactor->running = false; // Set running flag to false to stop the loop
-    return 0;
+    int result = wakeReactor(reactor); // Interrupt a blocking select()
+    reactor->producers--;
+    return result;
 }
 
 void reactorLoop(void* reactorPtr) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    reactor->loopThread = pthread_self();
+    reactor->inLoop.store(true, memory_order_release); // From now on other threads post instead of mutating
     while (reactor->running) {
         reactor->readSet = reactor->masterSet; // Copy master set to read set
-        int activity = select(reactor->fdMax + 1, &reactor->readSet, nullptr, nullptr, nullptr); // Wait for activity on any file descriptor
-        if (activity < 0 && errno != EINTR) {
+        reactor->writeSet = reactor->writeMasterSet; // Copy the write interest as well
+        int activity = select(reactor->fdMax + 1, &reactor->readSet, &reactor->writeSet, nullptr, nullptr); // Wait for activity on any file descriptor
+        if (activity < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
             std::cerr << "Error on select" << std::endl;
             break;
         }
-        for (int i = 0; i <= reactor->fdMax; ++i) {
+        for (int i = 0; i <= reactor->fdMax && reactor->running; ++i) {
+            if (FD_ISSET(i, &reactor->writeSet)) { // Flush pending output before reading more input
+                dispatch(reactor, reactor->writeHandlers, i);
+            }
             if (FD_ISSET(i, &reactor->readSet)) { // Check if the file descriptor is ready for reading
-                reactor->handlers[i](i); // Call the handler associated with the file descriptor
+                dispatch(reactor, reactor->handlers, i);
             }
         }
     }
+    reactor->inLoop.store(false, memory_order_release);
+    while (reactor->producers.load() != 0) {
+        sched_yield(); // Let in-flight posters finish touching the reactor
+    }
+    runPostedTasks(reactor); // Honour anything posted before the stop
+    close(reactor->wakeFd);
     delete reactor; // Clean up reactor resources
 }
 
@@ -1,10 +1,16 @@
 #ifndef REACTOR_HPP
 #define REACTOR_HPP
 
-#include <map>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
 #include <functional>
 #include <sys/select.h>
 #include <pthread.h>
+#include "../common/mpsc_queue.hpp"
 
 /* 
 The Reactor Pattern allows for efficient management of multiple I/O sources without the need for multi-threading.
@@ -22,9 +28,120 @@ Using a Proactor with a Reactor combines the benefits of both patterns:
 */
 
 // Define the reactor function type
+/// @brief Small-buffer callable used as a reactor handler.
+/// Behaves like std::function<void(int)>, but keeps callables of up to inlineSize
+/// bytes inside the object, so registering a typical lambda never allocates and a
+/// dispatch is a single indirect call.
+class ReactorHandler {
+public:
+    static const size_t inlineSize = 48; ///< Bytes of inline storage for the callable.
+
+    ReactorHandler() : invoker(nullptr), manager(nullptr) {}
+
+    /// @brief Wraps any callable taking the file descriptor.
+    template <typename F,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, ReactorHandler>::value>::type>
+    ReactorHandler(F&& f) : invoker(nullptr), manager(nullptr) {
+        typedef typename std::decay<F>::type Callable;
+        if (sizeof(Callable) <= inlineSize && alignof(Callable) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<Callable>::value) {
+            new (buffer) Callable(std::forward<F>(f));
+            invoker = &invokeInline<Callable>;
+            manager = &manageInline<Callable>;
+        } else {
+            *reinterpret_cast<Callable**>(buffer) = new Callable(std::forward<F>(f)); // Too large: fall back to the heap
+            invoker = &invokeHeap<Callable>;
+            manager = &manageHeap<Callable>;
+        }
+    }
+
+    ReactorHandler(const ReactorHandler& other) : invoker(other.invoker), manager(other.manager) {
+        if (manager) {
+            manager(buffer, const_cast<unsigned char*>(other.buffer), opCopy);
+        }
+    }
+
+    ReactorHandler(ReactorHandler&& other) noexcept : invoker(other.invoker), manager(other.manager) {
+        if (manager) {
+            manager(buffer, other.buffer, opMove);
+            other.invoker = nullptr;
+            other.manager = nullptr;
+        }
+    }
+
+    ReactorHandler& operator=(ReactorHandler other) noexcept {
+        reset();
+        if (other.manager) {
+            other.manager(buffer, other.buffer, opMove);
+            invoker = other.invoker;
+            manager = other.manager;
+            other.invoker = nullptr;
+            other.manager = nullptr;
+        }
+        return *this;
+    }
+
+    ~ReactorHandler() { reset(); }
+
+    /// @brief Destroys the wrapped callable, leaving the handler empty.
+    void reset() {
+        if (manager) {
+            manager(buffer, nullptr, opDestroy);
+        }
+        invoker = nullptr;
+        manager = nullptr;
+    }
+
+    /// @brief Invokes the wrapped callable.
+    void operator()(int fd) { invoker(buffer, fd); }
+
+    /// @brief True if a callable is wrapped.
+    explicit operator bool() const { return invoker != nullptr; }
+
+private:
+    enum Op { opCopy, opMove, opDestroy };
+    typedef void (*Invoker)(void* storage, int fd);
+    typedef void (*Manager)(void* dst, void* src, Op op);
+
+    template <typename F> static void invokeInline(void* storage, int fd) { (*static_cast<F*>(storage))(fd); }
+    template <typename F> static void invokeHeap(void* storage, int fd) { (**static_cast<F**>(storage))(fd); }
+
+    template <typename F> static void manageInline(void* dst, void* src, Op op) {
+        switch (op) {
+        case opCopy: new (dst) F(*static_cast<const F*>(src)); break;
+        case opMove: new (dst) F(std::move(*static_cast<F*>(src))); static_cast<F*>(src)->~F(); break;
+        case opDestroy: static_cast<F*>(dst)->~F(); break;
+        }
+    }
+
+    template <typename F> static void manageHeap(void* dst, void* src, Op op) {
+        switch (op) {
+        case opCopy: *static_cast<F**>(dst) = new F(**static_cast<F**>(src)); break;
+        case opMove: *static_cast<F**>(dst) = *static_cast<F**>(src); break;
+        case opDestroy: delete *static_cast<F**>(dst); break;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer[inlineSize]; ///< Inline callable, or a pointer to a heap one.
+    Invoker invoker; ///< Calls the stored callable.
+    Manager manager; ///< Copies, moves and destroys the stored callable.
+};
+
 /// @brief Type definition for reactor function.
 /// @param int File descriptor associated with the function.
-typedef std::function<void(int)> reactorFunc;
+typedef ReactorHandler reactorFunc;
+
+/// @brief One entry of the reactor's fd-indexed handler table.
+struct ReactorSlot {
+    reactorFunc func;      ///< Handler for the descriptor, empty when unused.
+    unsigned generation;   ///< Bumped on every add/remove so a dispatch can tell its slot changed under it.
+    bool active;           ///< True while the descriptor is registered.
+};
+
+// Define the reactor task type
+/// @brief Type definition for a closure posted to the reactor from another thread.
+/// The closure runs on the reactor thread, between two select() calls.
+typedef std::function<void()> reactorTask;
 
 // Define the reactor structure
 /// @brief Structure to hold reactor information and manage event-driven programming.
@@ -32,8 +149,19 @@ struct Reactor {
     fd_set masterSet; ///< Master set of file descriptors to monitor.
     fd_set readSet;   ///< Temporary set for select().
     int fdMax;        ///< Maximum file descriptor value.
-    std::map<int, reactorFunc> handlers; ///< Map of file descriptors to their associated handlers.
-    bool running;     ///< Flag to indicate if the reactor is running.
+    fd_set writeMasterSet; ///< Descriptors whose writability is being waited for.
+    fd_set writeSet;  ///< Temporary write set for select().
+    std::vector<ReactorSlot> handlers; ///< Read handler table indexed directly by file descriptor (FD_SETSIZE entries).
+    std::vector<ReactorSlot> writeHandlers; ///< Write handler table, same layout as handlers.
+    std::vector<ReactorSlot>* dispatchingTable; ///< Table of the handler currently running, or nullptr.
+    int dispatchingFd; ///< Descriptor whose handler is currently running, or -1.
+    reactorFunc deferredFunc; ///< Replacement handler registered for dispatchingFd while it runs.
+    std::atomic<bool> running; ///< Flag to indicate if the reactor is running.
+    int wakeFd;       ///< eventfd watched by select(), written to wake the loop from other threads.
+    std::atomic<bool> inLoop; ///< True while reactorLoop() is executing.
+    pthread_t loopThread;     ///< Thread running reactorLoop(), valid while inLoop is true.
+    MpscQueue<reactorTask> tasks; ///< Posted tasks: any thread pushes, the reactor thread pops.
+    std::atomic<int> producers; ///< Threads currently inside postToReactor()/stopReactor().
 };
 
 // Function prototypes for reactor
@@ -43,6 +171,8 @@ struct Reactor {
 void* startReactor();
 
 /// @brief Adds a file descriptor to the reactor.
+/// When called from a thread other than the one running reactorLoop(), the
+/// registration is posted to the reactor thread and applied there.
 /// @param reactor Pointer to the reactor.
 /// @param fd File descriptor to add.
 /// @param func Function to handle events on the file descriptor.
@@ -50,16 +180,46 @@ void* startReactor();
 int addFdToReactor(void* reactor, int fd, reactorFunc func);
 
 /// @brief Removes a file descriptor from the reactor.
+/// When called from a thread other than the one running reactorLoop(), the
+/// removal is posted to the reactor thread and applied there.
 /// @param reactor Pointer to the reactor.
 /// @param fd File descriptor to remove.
 /// @return 0 on success, -1 on failure.
 int removeFdFromReactor(void* reactor, int fd);
 
+/// @brief Adds a handler called when a file descriptor becomes writable.
+/// Used to finish writes that would otherwise block; remove it once the output is flushed.
+/// @param reactor Pointer to the reactor.
+/// @param fd File descriptor to watch.
+/// @param func Function to handle writability of the file descriptor.
+/// @return 0 on success, -1 on failure.
+int addWriteFdToReactor(void* reactor, int fd, reactorFunc func);
+
+/// @brief Stops waiting for a file descriptor to become writable.
+/// @param reactor Pointer to the reactor.
+/// @param fd File descriptor to stop watching.
+/// @return 0 on success, -1 on failure.
+int removeWriteFdFromReactor(void* reactor, int fd);
+
 /// @brief Stops the reactor.
+/// Safe to call from any thread; wakes the loop if it is blocked in select().
+/// The loop frees the reactor on exit, so nothing may be posted after this call.
 /// @param reactor Pointer to the reactor.
 /// @return 0 on success, -1 on failure.
 int stopReactor(void* reactor);
 
+/// @brief Posts a closure to be run on the reactor thread.
+/// Safe to call from any thread; the queue is lock-free and the loop is woken through its eventfd.
+/// @param reactor Pointer to the reactor.
+/// @param task Closure to run on the reactor thread.
+/// @return 0 on success, -1 on failure.
+int postToReactor(void* reactor, reactorTask task);
+
+/// @brief Wakes the reactor loop if it is blocked in select().
+/// @param reactor Pointer to the reactor.
+/// @return 0 on success, -1 on failure.
+int wakeReactor(void* reactor);
+
 /// @brief Main loop for the reactor to handle events.
 /// @param reactorPtr Pointer to the reactor.
 void reactorLoop(void* reactorPtr);
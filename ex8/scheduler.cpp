@@ -0,0 +1,211 @@
+#include "scheduler.hpp"
+#include <iostream>
+
+using namespace std;
+
+static const long INITIAL_DEQUE_CAPACITY = 256;
+static const int STEAL_ATTEMPTS = 4; // Random victims tried per worker before going to sleep
+
+// Worker the current thread belongs to, and its scheduler (both nullptr outside the pool)
+static thread_local SchedulerWorker* currentWorker = nullptr;
+static thread_local Scheduler* currentScheduler = nullptr;
+
+static StealArray* newStealArray(long capacity) {
+    StealArray* array = new StealArray();
+    array->capacity = capacity;
+    array->slots = new atomic<SchedulerTaskNode*>[capacity];
+    return array;
+}
+
+static void deleteStealArray(StealArray* array) {
+    delete[] array->slots;
+    delete array;
+}
+
+// Owner only: pushes a task at the bottom, growing the array when full.
+static void dequePush(StealDeque& deque, SchedulerTaskNode* node) {
+    long b = deque.bottom.load(memory_order_relaxed);
+    long t = deque.top.load(memory_order_acquire);
+    StealArray* array = deque.array.load(memory_order_relaxed);
+    if (b - t > array->capacity - 1) {
+        StealArray* bigger = newStealArray(array->capacity * 2);
+        for (long i = t; i < b; ++i) {
+            bigger->slots[i & (bigger->capacity - 1)].store(array->slots[i & (array->capacity - 1)].load(memory_order_relaxed), memory_order_relaxed);
+        }
+        deque.retired.push_back(array); // A thief may still be reading it
+        deque.array.store(bigger, memory_order_release);
+        array = bigger;
+    }
+    array->slots[b & (array->capacity - 1)].store(node, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    deque.bottom.store(b + 1, memory_order_relaxed);
+}
+
+// Owner only: pops the most recently pushed task, racing thieves for the last one.
+static SchedulerTaskNode* dequePop(StealDeque& deque) {
+    long b = deque.bottom.load(memory_order_relaxed) - 1;
+    StealArray* array = deque.array.load(memory_order_relaxed);
+    deque.bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = deque.top.load(memory_order_relaxed);
+    if (t > b) {
+        deque.bottom.store(b + 1, memory_order_relaxed); // Empty
+        return nullptr;
+    }
+    SchedulerTaskNode* node = array->slots[b & (array->capacity - 1)].load(memory_order_relaxed);
+    if (t == b) { // Last task: whoever advances top first gets it
+        if (!deque.top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            node = nullptr;
+        }
+        deque.bottom.store(b + 1, memory_order_relaxed);
+    }
+    return node;
+}
+
+// Any thread: steals the oldest task. Returns nullptr if empty or another thief won.
+static SchedulerTaskNode* dequeSteal(StealDeque& deque) {
+    long t = deque.top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = deque.bottom.load(memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    StealArray* array = deque.array.load(memory_order_acquire);
+    SchedulerTaskNode* node = array->slots[t & (array->capacity - 1)].load(memory_order_relaxed);
+    if (!deque.top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return nullptr;
+    }
+    return node;
+}
+
+// Finds work for a worker: own deque first, then the injection queue, then random victims.
+static SchedulerTaskNode* findTask(Scheduler* scheduler, SchedulerWorker* self) {
+    SchedulerTaskNode* node = dequePop(self->deque);
+    if (node) {
+        return node;
+    }
+    {
+        lock_guard<mutex> lock(scheduler->injectMutex);
+        if (!scheduler->injected.empty()) {
+            node = scheduler->injected.front();
+            scheduler->injected.pop_front();
+            return node;
+        }
+    }
+    // Same node first: its tasks' memory is local
+    const vector<SchedulerWorker*>& neighbors = scheduler->nodeWorkers[self->node];
+    if (neighbors.size() < scheduler->workers.size()) {
+        for (int attempt = 0; attempt < STEAL_ATTEMPTS * static_cast<int>(neighbors.size()); ++attempt) {
+            self->seed = self->seed * 1103515245u + 12345u;
+            SchedulerWorker* victim = neighbors[(self->seed >> 16) % neighbors.size()];
+            if (victim != self && (node = dequeSteal(victim->deque)) != nullptr) {
+                return node;
+            }
+        }
+    }
+    size_t count = scheduler->workers.size();
+    for (int attempt = 0; attempt < STEAL_ATTEMPTS * static_cast<int>(count); ++attempt) {
+        self->seed = self->seed * 1103515245u + 12345u; // Cheap LCG is enough to spread thieves
+        SchedulerWorker* victim = scheduler->workers[(self->seed >> 16) % count];
+        if (victim != self && (node = dequeSteal(victim->deque)) != nullptr) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+static void workerLoop(Scheduler* scheduler, SchedulerWorker* self) {
+    currentWorker = self;
+    currentScheduler = scheduler;
+    while (true) {
+        SchedulerTaskNode* node = findTask(scheduler, self);
+        if (node) {
+            scheduler->pending--;
+            node->task();
+            delete node;
+            continue;
+        }
+        unique_lock<mutex> lock(scheduler->sleepMutex);
+        scheduler->sleepers++;
+        scheduler->sleepCond.wait(lock, [scheduler]() { return scheduler->pending.load() > 0 || !scheduler->running; });
+        scheduler->sleepers--;
+        if (!scheduler->running && scheduler->pending.load() == 0) {
+            break; // Stopped and drained
+        }
+    }
+    currentWorker = nullptr;
+    currentScheduler = nullptr;
+}
+
+void* startScheduler(int workers) {
+    if (workers <= 0) {
+        workers = static_cast<int>(thread::hardware_concurrency());
+        if (workers <= 0) {
+            workers = 1;
+        }
+    }
+    Scheduler* scheduler = new Scheduler();
+    scheduler->pending = 0;
+    scheduler->sleepers = 0;
+    scheduler->running = true;
+    const NumaTopology& topology = NumaTopology::get();
+    scheduler->nodeWorkers.resize(topology.numNodes());
+    for (int i = 0; i < workers; ++i) {
+        SchedulerWorker* worker = new SchedulerWorker();
+        worker->deque.top = 0;
+        worker->deque.bottom = 0;
+        worker->deque.array = newStealArray(INITIAL_DEQUE_CAPACITY);
+        worker->seed = 2654435761u * static_cast<unsigned>(i + 1);
+        worker->node = topology.nodeOf(i, workers);
+        scheduler->workers.push_back(worker);
+        scheduler->nodeWorkers[worker->node].push_back(worker);
+    }
+    for (SchedulerWorker* worker : scheduler->workers) { // Start only once the worker list is complete
+        worker->thread = thread(workerLoop, scheduler, worker);
+        pinThreadToNode(worker->thread.native_handle(), worker->node); // No-op with a single node
+    }
+    return scheduler;
+}
+
+int submitTask(void* schedulerPtr, schedulerTask task) {
+    Scheduler* scheduler = static_cast<Scheduler*>(schedulerPtr);
+    SchedulerTaskNode* node = new SchedulerTaskNode();
+    node->task = std::move(task);
+    if (currentScheduler == scheduler) {
+        dequePush(currentWorker->deque, node); // Spawned by a task: keep it local, others may steal it
+    } else {
+        lock_guard<mutex> lock(scheduler->injectMutex);
+        scheduler->injected.push_back(node);
+    }
+    scheduler->pending++;
+    if (scheduler->sleepers.load() > 0) {
+        lock_guard<mutex> lock(scheduler->sleepMutex); // Pairs with the predicate check in workerLoop
+        scheduler->sleepCond.notify_one();
+    }
+    return 0;
+}
+
+int stopScheduler(void* schedulerPtr) {
+    Scheduler* scheduler = static_cast<Scheduler*>(schedulerPtr);
+    if (currentScheduler == scheduler) {
+        cerr << "stopScheduler called from a worker" << endl;
+        return -1;
+    }
+    {
+        lock_guard<mutex> lock(scheduler->sleepMutex);
+        scheduler->running = false;
+    }
+    scheduler->sleepCond.notify_all();
+    for (SchedulerWorker* worker : scheduler->workers) {
+        worker->thread.join();
+    }
+    for (SchedulerWorker* worker : scheduler->workers) {
+        for (StealArray* array : worker->deque.retired) {
+            deleteStealArray(array);
+        }
+        deleteStealArray(worker->deque.array.load());
+        delete worker;
+    }
+    delete scheduler;
+    return 0;
+}
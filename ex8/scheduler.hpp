@@ -0,0 +1,91 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include "../common/numa_topology.hpp"
+
+/*
+A work-stealing task scheduler.
+
+Every worker owns a deque: it pushes and pops its own tasks at the bottom (LIFO, cache
+friendly), while idle workers steal from the top of a randomly chosen victim (FIFO, oldest
+and usually largest work first). Tasks submitted from outside the pool - the reactor thread,
+for instance - go through a shared injection queue. With one worker per core, a burst of
+cheap commands and a few expensive SCC computations spread over all cores without creating
+a thread per request.
+
+On a machine with several NUMA nodes the workers are split into one contiguous group per node
+and pinned to its CPUs, and a thief tries the workers of its own node before the others: a
+stolen task then keeps running next to the memory its spawner placed.
+*/
+
+// Define the scheduler task type
+/// @brief Type definition for a task run by the scheduler.
+typedef std::function<void()> schedulerTask;
+
+/// @brief A submitted task; the deques hold pointers so they can be moved with single atomic stores.
+struct SchedulerTaskNode {
+    schedulerTask task; ///< Closure to run on a worker.
+};
+
+/// @brief Circular array backing a work-stealing deque.
+struct StealArray {
+    long capacity;                          ///< Number of slots (power of two).
+    std::atomic<SchedulerTaskNode*>* slots; ///< Task pointers, indexed modulo capacity.
+};
+
+/// @brief Chase-Lev work-stealing deque: the owner pushes and pops at the bottom, thieves steal from the top.
+struct StealDeque {
+    std::atomic<long> top;     ///< Next index to steal from.
+    std::atomic<long> bottom;  ///< Next index the owner pushes to.
+    std::atomic<StealArray*> array; ///< Current backing array.
+    std::vector<StealArray*> retired; ///< Outgrown arrays, freed with the deque (thieves may still read them).
+};
+
+/// @brief State of one worker thread.
+struct SchedulerWorker {
+    StealDeque deque;    ///< Tasks owned by this worker.
+    std::thread thread;  ///< The worker thread.
+    unsigned seed;       ///< State of the victim-selection random generator.
+    int node;            ///< NUMA node the worker is pinned to.
+};
+
+/// @brief Structure holding the scheduler state.
+struct Scheduler {
+    std::vector<SchedulerWorker*> workers; ///< Worker threads.
+    std::vector<std::vector<SchedulerWorker*>> nodeWorkers; ///< Worker threads of each NUMA node.
+    std::mutex injectMutex;                ///< Protects injected.
+    std::deque<SchedulerTaskNode*> injected; ///< Tasks submitted from outside the pool.
+    std::mutex sleepMutex;                 ///< Protects sleeping workers.
+    std::condition_variable sleepCond;     ///< Idle workers wait here.
+    std::atomic<long> pending;             ///< Tasks queued but not yet picked up.
+    std::atomic<int> sleepers;             ///< Workers waiting on sleepCond.
+    std::atomic<bool> running;             ///< Flag to indicate if the scheduler is running.
+};
+
+// Function prototypes for the scheduler
+
+/// @brief Starts a scheduler.
+/// @param workers Number of worker threads, or 0 for one per hardware thread.
+/// @return Pointer to the scheduler.
+void* startScheduler(int workers);
+
+/// @brief Submits a task. Safe to call from any thread; a worker submitting pushes onto its own deque.
+/// @param scheduler Pointer to the scheduler.
+/// @param task Closure to run on a worker.
+/// @return 0 on success, -1 on failure.
+int submitTask(void* scheduler, schedulerTask task);
+
+/// @brief Runs the remaining tasks, joins the workers and frees the scheduler.
+/// Must not be called from a worker.
+/// @param scheduler Pointer to the scheduler.
+/// @return 0 on success, -1 on failure.
+int stopScheduler(void* scheduler);
+
+#endif // SCHEDULER_HPP
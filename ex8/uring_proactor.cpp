@@ -0,0 +1,598 @@
+#include "uring_proactor.hpp"
+#include <unistd.h>
+#include <iostream>
+#include <cstring> // For memset
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+static const unsigned URING_ENTRIES = 256;     // Submission queue size
+static const unsigned URING_BUF_COUNT = 256;   // Provided receive buffers (power of two)
+static const unsigned URING_BUF_SIZE = 4096;   // Bytes per provided buffer
+static const unsigned URING_BUF_GROUP = 1;     // Buffer group id used by recv
+static const long long URING_ACCEPT_RETRY_NS = 100000000; // Pause before accepting again after EMFILE and the like
+
+// Thin wrappers around the raw system calls (no liburing dependency)
+
+static int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int uringRegister(int ringFd, unsigned opcode, void* arg, unsigned nrArgs) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, nrArgs));
+}
+
+// Submits queued SQEs and, if waitFor > 0, waits for that many completions.
+static int submitAndWait(UringProactor* proactor, unsigned waitFor) {
+    unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int result;
+    do {
+        result = uringEnter(proactor->ringFd, proactor->toSubmit, waitFor, flags);
+    } while (result < 0 && errno == EINTR);
+    if (result >= 0) {
+        proactor->toSubmit = 0;
+    }
+    return result;
+}
+
+// Returns a zeroed SQE, flushing the ring to the kernel first if it is full.
+static io_uring_sqe* getSqe(UringProactor* proactor) {
+    unsigned tail = *proactor->sqTail;
+    if (tail - __atomic_load_n(proactor->sqHead, __ATOMIC_ACQUIRE) >= proactor->sqEntries) {
+        submitAndWait(proactor, 0); // Make room by handing the pending entries to the kernel
+        if (tail - __atomic_load_n(proactor->sqHead, __ATOMIC_ACQUIRE) >= proactor->sqEntries) {
+            return nullptr;
+        }
+    }
+    unsigned index = tail & proactor->sqMask;
+    io_uring_sqe* sqe = &proactor->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    proactor->sqArray[index] = index;
+    __atomic_store_n(proactor->sqTail, tail + 1, __ATOMIC_RELEASE); // Publish the entry
+    ++proactor->toSubmit;
+    return sqe;
+}
+
+// Hands a provided buffer back to the kernel after its data has been consumed.
+static void recycleBuffer(UringProactor* proactor, unsigned short bid) {
+    unsigned short tail = proactor->bufRing->tail;
+    // Index from the ring base: in C++ the header's flexible 'bufs' member does not start at offset 0
+    io_uring_buf* buf = reinterpret_cast<io_uring_buf*>(proactor->bufRing) + (tail & (proactor->bufCount - 1));
+    buf->addr = reinterpret_cast<uint64_t>(proactor->bufBase + static_cast<size_t>(bid) * proactor->bufSize);
+    buf->len = proactor->bufSize;
+    buf->bid = bid;
+    __atomic_store_n(&proactor->bufRing->tail, static_cast<unsigned short>(tail + 1), __ATOMIC_RELEASE);
+}
+
+static void armAccept(UringProactor* proactor) {
+    io_uring_sqe* sqe = getSqe(proactor);
+    if (!sqe) {
+        cerr << "io_uring submission queue full" << endl;
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = proactor->listenFd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT; // One SQE, a completion per accepted connection
+    sqe->user_data = reinterpret_cast<uint64_t>(&proactor->acceptOp);
+    proactor->acceptArmed = true;
+}
+
+// Arms a timer whose completion re-arms the accept.
+static void armAcceptRetry(UringProactor* proactor) {
+    io_uring_sqe* sqe = getSqe(proactor);
+    if (!sqe) {
+        cerr << "io_uring submission queue full" << endl;
+        return;
+    }
+    proactor->acceptRetryDelay.tv_sec = 0;
+    proactor->acceptRetryDelay.tv_nsec = URING_ACCEPT_RETRY_NS;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&proactor->acceptRetryDelay);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<uint64_t>(&proactor->acceptRetryOp);
+    proactor->acceptRetryArmed = true;
+}
+
+// Re-arms the accept after the kernel dropped it because of an error.
+static void rearmAccept(UringProactor* proactor, int error) {
+    switch (error) {
+    case EMFILE:
+    case ENFILE:
+    case ENOBUFS:
+    case ENOMEM:
+        armAcceptRetry(proactor); // Re-arming at once would fail the same way, in a busy loop
+        break;
+    case EBADF:
+    case EINVAL:
+    case ENOTSOCK:
+    case EOPNOTSUPP:
+        cerr << "No longer accepting connections" << endl; // The listening socket itself is unusable
+        break;
+    default:
+        armAccept(proactor); // The error concerned one connection (e.g. ECONNABORTED)
+        break;
+    }
+}
+
+static void armRecv(UringProactor* proactor, int fd) {
+    io_uring_sqe* sqe = getSqe(proactor);
+    if (!sqe) {
+        cerr << "io_uring submission queue full" << endl;
+        return;
+    }
+    UringConn& conn = *proactor->conns[fd];
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT; // Keep receiving until an error or EOF
+    sqe->flags = IOSQE_BUFFER_SELECT;    // Let the kernel pick a buffer from our group
+    sqe->buf_group = URING_BUF_GROUP;
+    sqe->user_data = reinterpret_cast<uint64_t>(&conn.recvOp);
+    conn.recvArmed = true;
+}
+
+static void armWake(UringProactor* proactor) {
+    io_uring_sqe* sqe = getSqe(proactor);
+    if (!sqe) {
+        cerr << "io_uring submission queue full" << endl;
+        return;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = proactor->wakeFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&proactor->wakeValue);
+    sqe->len = sizeof(proactor->wakeValue);
+    sqe->user_data = reinterpret_cast<uint64_t>(&proactor->wakeOp);
+    proactor->wakeArmed = true;
+}
+
+// Submits every queued send of a connection as one linked chain, so they hit the socket in order.
+static void flushSends(UringProactor* proactor, int fd) {
+    UringConn& conn = *proactor->conns[fd];
+    if (conn.sendsInFlight > 0) {
+        return; // The next chain goes out when the current one has completed
+    }
+    io_uring_sqe* previous = nullptr;
+    while (!conn.sendQueue.empty()) {
+        UringOp* op = conn.sendQueue.front();
+        io_uring_sqe* sqe = getSqe(proactor);
+        if (!sqe) {
+            break; // Retry on the next completion
+        }
+        if (previous) {
+            previous->flags |= IOSQE_IO_LINK; // Start this send only after the previous one succeeded
+        }
+        conn.sendQueue.pop_front();
+        conn.sendChain.push_back(op);
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(op->data.data() + op->offset);
+        sqe->len = static_cast<unsigned>(op->data.size() - op->offset);
+        sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL; // A short send breaks the chain instead of reordering it
+        sqe->user_data = reinterpret_cast<uint64_t>(op);
+        ++conn.sendsInFlight;
+        previous = sqe;
+    }
+}
+
+// Closes a connection once nothing references its descriptor any more.
+static void maybeClose(UringProactor* proactor, int fd) {
+    UringConn& conn = *proactor->conns[fd];
+    if (!conn.open || !conn.closing || conn.recvArmed || conn.sendsInFlight > 0) {
+        return;
+    }
+    for (UringOp* op : conn.sendQueue) {
+        delete op; // Unsent data of a dead connection
+    }
+    conn.sendQueue.clear();
+    conn.open = false;
+    conn.closing = false;
+    close(fd);
+}
+
+static void handleCompletion(UringProactor* proactor, const io_uring_cqe* cqe) {
+    UringOp* op = reinterpret_cast<UringOp*>(cqe->user_data);
+    bool more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    switch (op->kind) {
+    case URING_OP_ACCEPT: {
+        if (cqe->res >= 0) {
+            int fd = cqe->res;
+            if (static_cast<size_t>(fd) >= proactor->conns.size()) {
+                proactor->conns.resize(fd + 1, nullptr);
+            }
+            if (!proactor->conns[fd]) {
+                proactor->conns[fd] = new UringConn();
+            }
+            UringConn& conn = *proactor->conns[fd];
+            conn.open = true;
+            conn.closing = false;
+            conn.closeRequested = false;
+            conn.reported = false;
+            conn.sendsInFlight = 0;
+            conn.pendingBytes = 0;
+            conn.recvOp.kind = URING_OP_RECV;
+            conn.recvOp.fd = fd;
+            if (proactor->onAccept) {
+                proactor->onAccept(fd);
+            }
+            armRecv(proactor, fd);
+        } else {
+            cerr << "Error on accept: " << strerror(-cqe->res) << endl;
+        }
+        if (!more) {
+            proactor->acceptArmed = false;
+            if (proactor->running && cqe->res >= 0) {
+                armAccept(proactor); // The kernel dropped the multishot accept; re-arm it
+            } else if (proactor->running) {
+                rearmAccept(proactor, -cqe->res);
+            }
+        }
+        break;
+    }
+    case URING_OP_RECV: {
+        int fd = op->fd;
+        UringConn& conn = *proactor->conns[fd];
+        if (cqe->res > 0) {
+            unsigned short bid = static_cast<unsigned short>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+            proactor->onRecv(fd, proactor->bufBase + static_cast<size_t>(bid) * proactor->bufSize, cqe->res);
+            recycleBuffer(proactor, bid);
+            if (!more) {
+                armRecv(proactor, fd); // Multishot ended (e.g. buffers ran dry); keep receiving
+            }
+        } else if (cqe->res == -ENOBUFS) {
+            armRecv(proactor, fd); // All buffers were in use; they are back in the ring now
+        } else {
+            conn.recvArmed = false;
+            if (!conn.reported && !conn.closeRequested) { // Also after a failed send: the application must hear of it once
+                conn.reported = true;
+                proactor->onRecv(fd, nullptr, cqe->res); // 0 = hang up, < 0 = error
+            }
+            conn.closing = true;
+            maybeClose(proactor, fd);
+        }
+        break;
+    }
+    case URING_OP_SEND: {
+        int fd = op->fd;
+        UringConn& conn = *proactor->conns[fd];
+        --conn.sendsInFlight;
+        if (cqe->res >= 0) {
+            op->offset += cqe->res; // A short send cancels the rest of the chain; it is resent below
+        } else if (cqe->res != -ECANCELED) {
+            if (!conn.closing) {
+                shutdown(fd, SHUT_RD); // Ends the recv, whose completion reports the failure
+            }
+            conn.closing = true; // The socket is broken; drop it once the chain has drained
+        }
+        if (conn.sendsInFlight > 0) {
+            break; // Wait for the whole chain before deciding what to resend
+        }
+        while (!conn.sendChain.empty()) {
+            UringOp* sent = conn.sendChain.back();
+            conn.sendChain.pop_back();
+            if (sent->offset >= sent->data.size() || conn.closing) {
+                conn.pendingBytes -= sent->data.size();
+                delete sent;
+            } else {
+                conn.sendQueue.push_front(sent); // Unfinished sends go first, in their original order
+            }
+        }
+        if (conn.closing) {
+            maybeClose(proactor, fd);
+        } else if (conn.pendingBytes == 0) {
+            if (proactor->onDrained) {
+                proactor->onDrained(fd); // May queue more sends
+            }
+        } else {
+            flushSends(proactor, fd);
+        }
+        break;
+    }
+    case URING_OP_WAKE: {
+        proactor->wakeArmed = false;
+        vector<function<void()>> batch;
+        {
+            lock_guard<mutex> lock(proactor->postedMutex);
+            batch.swap(proactor->posted);
+        }
+        for (function<void()>& task : batch) {
+            task();
+        }
+        if (proactor->running) {
+            armWake(proactor);
+        }
+        break;
+    }
+    case URING_OP_TIMEOUT:
+        proactor->acceptRetryArmed = false;
+        if (proactor->running) {
+            armAccept(proactor);
+        }
+        break;
+    }
+}
+
+// Handles a completion posted during the teardown: only the bookkeeping of what is in flight.
+static void retireCompletion(UringProactor* proactor, const io_uring_cqe* cqe) {
+    UringOp* op = reinterpret_cast<UringOp*>(cqe->user_data);
+    if (!op) {
+        return; // The cancel request itself
+    }
+    bool more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    switch (op->kind) {
+    case URING_OP_ACCEPT:
+        if (cqe->res >= 0) {
+            close(cqe->res); // Accepted before the cancel took effect
+        }
+        if (!more) {
+            proactor->acceptArmed = false;
+        }
+        break;
+    case URING_OP_RECV:
+        if (!more) {
+            proactor->conns[op->fd]->recvArmed = false;
+        }
+        break;
+    case URING_OP_SEND:
+        --proactor->conns[op->fd]->sendsInFlight;
+        break;
+    case URING_OP_WAKE:
+        proactor->wakeArmed = false;
+        break;
+    case URING_OP_TIMEOUT:
+        proactor->acceptRetryArmed = false;
+        break;
+    }
+}
+
+// Handles every completion the kernel has posted.
+static void reapCompletions(UringProactor* proactor, void (*handler)(UringProactor*, const io_uring_cqe*)) {
+    unsigned head = *proactor->cqHead;
+    unsigned tail = __atomic_load_n(proactor->cqTail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        handler(proactor, &proactor->cqes[head & proactor->cqMask]);
+        ++head;
+        __atomic_store_n(proactor->cqHead, head, __ATOMIC_RELEASE);
+        if (head == tail) {
+            tail = __atomic_load_n(proactor->cqTail, __ATOMIC_ACQUIRE);
+        }
+    }
+}
+
+// Number of requests the kernel still holds, each referencing an op record and maybe a buffer.
+static unsigned requestsInFlight(const UringProactor* proactor) {
+    unsigned count = proactor->acceptArmed + proactor->acceptRetryArmed + proactor->wakeArmed;
+    for (const UringConn* conn : proactor->conns) {
+        if (conn) {
+            count += conn->recvArmed + conn->sendsInFlight;
+        }
+    }
+    return count;
+}
+
+// Cancels every request of the ring and waits until all of them have completed.
+// @return false if the ring failed first, so the kernel may still use the memory they reference.
+static bool cancelRequests(UringProactor* proactor) {
+    if (requestsInFlight(proactor) == 0) {
+        return true;
+    }
+    io_uring_sqe* sqe = getSqe(proactor);
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY; // Multishot and linked requests included
+    sqe->user_data = 0;
+    while (requestsInFlight(proactor) > 0) {
+        if (submitAndWait(proactor, 1) < 0) {
+            return false;
+        }
+        reapCompletions(proactor, retireCompletion);
+    }
+    return true;
+}
+
+void* startUringProactor(int listenFd, proactorFunc acceptFunc, proactorRecvFunc recvFunc, proactorFunc drainedFunc) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ringFd = uringSetup(URING_ENTRIES, &params);
+    if (ringFd < 0) {
+        cerr << "io_uring unavailable: " << strerror(errno) << endl;
+        return nullptr;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        cerr << "io_uring too old (no single mmap)" << endl;
+        close(ringFd);
+        return nullptr;
+    }
+
+    UringProactor* proactor = new UringProactor();
+    proactor->ringFd = ringFd;
+    proactor->listenFd = listenFd;
+    proactor->onAccept = acceptFunc;
+    proactor->onRecv = recvFunc;
+    proactor->onDrained = drainedFunc;
+    proactor->running = true;
+    proactor->toSubmit = 0;
+    proactor->acceptArmed = false;
+    proactor->acceptRetryArmed = false;
+    proactor->wakeArmed = false;
+
+    // Map the submission and completion rings (one mapping) and the SQE array
+    proactor->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    proactor->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (proactor->cqRingSize > proactor->sqRingSize) {
+        proactor->sqRingSize = proactor->cqRingSize;
+    }
+    proactor->cqRingSize = proactor->sqRingSize;
+    proactor->sqRing = mmap(nullptr, proactor->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    proactor->cqRing = proactor->sqRing;
+    proactor->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    proactor->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, proactor->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+    if (proactor->sqRing == MAP_FAILED || proactor->sqes == MAP_FAILED) {
+        cerr << "Error mapping io_uring rings" << endl;
+        close(ringFd);
+        delete proactor;
+        return nullptr;
+    }
+    char* sq = static_cast<char*>(proactor->sqRing);
+    proactor->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    proactor->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    proactor->sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    proactor->sqEntries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    proactor->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(proactor->cqRing);
+    proactor->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    proactor->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    proactor->cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    proactor->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Register a ring of provided buffers for recv to pick from
+    proactor->bufCount = URING_BUF_COUNT;
+    proactor->bufSize = URING_BUF_SIZE;
+    proactor->bufRingSize = proactor->bufCount * sizeof(io_uring_buf);
+    proactor->bufRing = static_cast<io_uring_buf_ring*>(mmap(nullptr, proactor->bufRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_POPULATE, -1, 0));
+    proactor->bufBase = new char[static_cast<size_t>(proactor->bufCount) * proactor->bufSize];
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(proactor->bufRing);
+    reg.ring_entries = proactor->bufCount;
+    reg.bgid = URING_BUF_GROUP;
+    if (proactor->bufRing == MAP_FAILED || uringRegister(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        cerr << "io_uring provided buffer rings unsupported" << endl;
+        if (proactor->bufRing != MAP_FAILED) {
+            munmap(proactor->bufRing, proactor->bufRingSize);
+        }
+        munmap(proactor->sqes, proactor->sqesSize);
+        munmap(proactor->sqRing, proactor->sqRingSize);
+        delete[] proactor->bufBase;
+        close(ringFd);
+        delete proactor;
+        return nullptr;
+    }
+    proactor->bufRing->tail = 0;
+    for (unsigned i = 0; i < proactor->bufCount; ++i) {
+        recycleBuffer(proactor, static_cast<unsigned short>(i));
+    }
+
+    proactor->wakeFd = eventfd(0, EFD_CLOEXEC);
+    proactor->acceptOp.kind = URING_OP_ACCEPT;
+    proactor->acceptOp.fd = listenFd;
+    proactor->wakeOp.kind = URING_OP_WAKE;
+    proactor->wakeOp.fd = proactor->wakeFd;
+    proactor->acceptRetryOp.kind = URING_OP_TIMEOUT;
+    proactor->acceptRetryOp.fd = -1;
+    armAccept(proactor);
+    armWake(proactor);
+    return proactor;
+}
+
+void uringProactorLoop(void* proactorPtr) {
+    UringProactor* proactor = static_cast<UringProactor*>(proactorPtr);
+    while (proactor->running) {
+        if (submitAndWait(proactor, 1) < 0) { // One syscall submits the batch and waits for completions
+            cerr << "Error on io_uring_enter: " << strerror(errno) << endl;
+            break;
+        }
+        reapCompletions(proactor, handleCompletion);
+    }
+
+    // Tear down. Closing the ring only starts cancelling what is in flight, and until each request
+    // has completed the kernel may still write into the provided buffers or read a send buffer.
+    bool idle = cancelRequests(proactor);
+    close(proactor->ringFd);
+    if (!idle) {
+        cerr << "Error cancelling io_uring requests: " << strerror(errno) << endl;
+        return; // Leak the proactor rather than free memory the kernel may still use
+    }
+    for (size_t fd = 0; fd < proactor->conns.size(); ++fd) {
+        UringConn* conn = proactor->conns[fd];
+        if (!conn) {
+            continue;
+        }
+        for (UringOp* op : conn->sendQueue) {
+            delete op;
+        }
+        for (UringOp* op : conn->sendChain) {
+            delete op;
+        }
+        if (conn->open) {
+            close(static_cast<int>(fd));
+        }
+        delete conn;
+    }
+    munmap(proactor->bufRing, proactor->bufRingSize);
+    munmap(proactor->sqes, proactor->sqesSize);
+    munmap(proactor->sqRing, proactor->sqRingSize);
+    delete[] proactor->bufBase;
+    close(proactor->wakeFd);
+    delete proactor;
+}
+
+int uringSend(void* proactorPtr, int sockfd, const char* data, size_t len) {
+    UringProactor* proactor = static_cast<UringProactor*>(proactorPtr);
+    if (sockfd < 0 || static_cast<size_t>(sockfd) >= proactor->conns.size() ||
+        !proactor->conns[sockfd] || !proactor->conns[sockfd]->open) {
+        return -1;
+    }
+    UringOp* op = new UringOp();
+    op->kind = URING_OP_SEND;
+    op->fd = sockfd;
+    op->data.assign(data, data + len); // The buffer must outlive the asynchronous send
+    op->offset = 0;
+    proactor->conns[sockfd]->sendQueue.push_back(op);
+    proactor->conns[sockfd]->pendingBytes += len;
+    flushSends(proactor, sockfd);
+    return 0;
+}
+
+size_t uringPendingOutput(void* proactorPtr, int sockfd) {
+    UringProactor* proactor = static_cast<UringProactor*>(proactorPtr);
+    if (sockfd < 0 || static_cast<size_t>(sockfd) >= proactor->conns.size() || !proactor->conns[sockfd]) {
+        return 0;
+    }
+    return proactor->conns[sockfd]->pendingBytes;
+}
+
+int uringClose(void* proactorPtr, int sockfd) {
+    UringProactor* proactor = static_cast<UringProactor*>(proactorPtr);
+    if (sockfd < 0 || static_cast<size_t>(sockfd) >= proactor->conns.size() ||
+        !proactor->conns[sockfd] || !proactor->conns[sockfd]->open) {
+        return -1;
+    }
+    proactor->conns[sockfd]->closing = true;
+    proactor->conns[sockfd]->closeRequested = true;
+    shutdown(sockfd, SHUT_RD); // Ends the multishot recv; the socket closes after pending sends
+    return 0;
+}
+
+int postToUringProactor(void* proactorPtr, function<void()> task) {
+    UringProactor* proactor = static_cast<UringProactor*>(proactorPtr);
+    {
+        lock_guard<mutex> lock(proactor->postedMutex);
+        proactor->posted.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    if (write(proactor->wakeFd, &one, sizeof(one)) < 0) { // Completes the pending eventfd read
+        return -1;
+    }
+    return 0;
+}
+
+int stopUringProactor(void* proactorPtr) {
+    UringProactor* proactor = static_cast<UringProactor*>(proactorPtr);
+    proactor->running = false;
+    uint64_t one = 1;
+    if (write(proactor->wakeFd, &one, sizeof(one)) < 0) { // Completes the pending eventfd read
+        return -1;
+    }
+    return 0;
+}
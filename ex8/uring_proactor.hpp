@@ -0,0 +1,157 @@
+#ifndef URING_PROACTOR_HPP
+#define URING_PROACTOR_HPP
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include "reactor.hpp"
+
+/*
+A completion-based proactor on top of Linux io_uring.
+
+Unlike startProactor(), which parks a thread in a blocking read() per client, the
+io_uring proactor runs on a single thread: the kernel accepts connections and receives
+data on our behalf (multishot accept, multishot recv into a ring of provided buffers)
+and only tells us when an operation has completed. Submissions and completions are
+batched, so one io_uring_enter() call serves many clients.
+*/
+
+// Define the completion handler type
+/// @brief Type definition for the receive completion handler.
+/// @param sockfd File descriptor the data was received on.
+/// @param data Received bytes; only valid for the duration of the call.
+/// @param len Number of bytes received, 0 when the peer hung up, -errno on error.
+/// @return Pointer to the result.
+typedef void* (*proactorRecvFunc)(int sockfd, const char* data, int len);
+
+/// @brief Kinds of operations the proactor keeps in flight.
+enum UringOpKind {
+    URING_OP_ACCEPT, ///< Multishot accept on the listening socket.
+    URING_OP_RECV,   ///< Multishot recv on a client socket.
+    URING_OP_SEND,   ///< Send of a queued response.
+    URING_OP_WAKE,   ///< Read on the eventfd used by stopUringProactor() and postToUringProactor().
+    URING_OP_TIMEOUT ///< Pause before re-arming the accept after running out of descriptors or memory.
+};
+
+/// @brief An operation submitted to the ring; its address is the SQE's user_data.
+struct UringOp {
+    UringOpKind kind; ///< What the completion belongs to.
+    int fd;           ///< Socket the operation runs on.
+    std::vector<char> data; ///< Bytes to send (URING_OP_SEND only).
+    size_t offset;    ///< Bytes of data already sent.
+};
+
+/// @brief Per-connection bookkeeping, indexed by file descriptor.
+struct UringConn {
+    bool open;          ///< True between accept and close.
+    bool recvArmed;     ///< True while the multishot recv is active.
+    bool closing;       ///< Close once the recv is gone and all sends completed.
+    bool closeRequested; ///< The application asked for the close (uringClose()): nothing to report.
+    bool reported;      ///< The end of the connection was reported to onRecv.
+    int sendsInFlight;  ///< Sends submitted but not completed.
+    size_t pendingBytes; ///< Bytes queued by uringSend() that the socket has not taken yet.
+    UringOp recvOp;     ///< Operation record for the multishot recv.
+    std::deque<UringOp*> sendQueue; ///< Sends waiting for the in-flight chain to finish.
+    std::deque<UringOp*> sendChain; ///< Sends of the in-flight chain, in submission order.
+};
+
+/// @brief Structure to hold the io_uring proactor state.
+struct UringProactor {
+    int ringFd;          ///< io_uring instance.
+    void* sqRing;        ///< Mapped submission ring.
+    size_t sqRingSize;   ///< Size of the submission ring mapping.
+    void* cqRing;        ///< Mapped completion ring (may alias sqRing).
+    size_t cqRingSize;   ///< Size of the completion ring mapping.
+    io_uring_sqe* sqes;  ///< Mapped submission queue entries.
+    size_t sqesSize;     ///< Size of the SQE array mapping.
+    unsigned* sqHead;    ///< Kernel-owned submission head.
+    unsigned* sqTail;    ///< Our submission tail.
+    unsigned sqMask;     ///< Submission ring mask.
+    unsigned sqEntries;  ///< Number of submission entries.
+    unsigned* sqArray;   ///< Submission index array.
+    unsigned* cqHead;    ///< Our completion head.
+    unsigned* cqTail;    ///< Kernel-owned completion tail.
+    unsigned cqMask;     ///< Completion ring mask.
+    io_uring_cqe* cqes;  ///< Completion entries.
+    unsigned toSubmit;   ///< SQEs queued since the last io_uring_enter().
+
+    io_uring_buf_ring* bufRing; ///< Ring of buffers the kernel picks from for recv.
+    size_t bufRingSize;  ///< Size of the buffer ring mapping.
+    char* bufBase;       ///< Backing storage for the provided buffers.
+    unsigned bufCount;   ///< Number of provided buffers (power of two).
+    unsigned bufSize;    ///< Size of each provided buffer.
+
+    int listenFd;        ///< Listening socket.
+    int wakeFd;          ///< eventfd written by stopUringProactor() and postToUringProactor().
+    uint64_t wakeValue;  ///< Read target for the eventfd.
+    std::atomic<bool> running; ///< Flag to indicate if the proactor is running.
+    UringOp acceptOp;    ///< Operation record for the multishot accept.
+    UringOp wakeOp;      ///< Operation record for the eventfd read.
+    UringOp acceptRetryOp; ///< Operation record for the pause before re-arming the accept.
+    __kernel_timespec acceptRetryDelay; ///< Length of that pause.
+    bool acceptArmed;    ///< True while the multishot accept is active.
+    bool acceptRetryArmed; ///< True while the accept waits for its pause to end.
+    bool wakeArmed;      ///< True while the eventfd read is active.
+    std::mutex postedMutex; ///< Protects posted.
+    std::vector<std::function<void()>> posted; ///< Tasks posted from other threads.
+    std::vector<UringConn*> conns; ///< Connections indexed by file descriptor (stable addresses for user_data).
+    proactorFunc onAccept;    ///< Called for every accepted connection.
+    proactorRecvFunc onRecv;  ///< Called for every receive completion.
+    proactorFunc onDrained;   ///< Called when a connection's queued sends have all completed.
+};
+
+// Function prototypes for the io_uring proactor
+
+/// @brief Creates an io_uring proactor serving a listening socket.
+/// @param listenFd Listening socket to accept connections on.
+/// @param acceptFunc Called on the proactor thread for each new connection (may be nullptr).
+/// @param recvFunc Called on the proactor thread for each receive completion.
+/// @param drainedFunc Called on the proactor thread when all sends queued on a connection have
+///                    completed, after uringPendingOutput() had gone above 0 (may be nullptr).
+/// @return Pointer to the proactor, or nullptr if io_uring is unavailable.
+void* startUringProactor(int listenFd, proactorFunc acceptFunc, proactorRecvFunc recvFunc, proactorFunc drainedFunc = nullptr);
+
+/// @brief Runs the completion loop until stopUringProactor() is called, then frees the proactor.
+/// @param proactor Pointer to the proactor.
+void uringProactorLoop(void* proactor);
+
+/// @brief Queues a send on a connection. Sends on one socket complete in the order they were queued.
+/// Must be called on the proactor thread (i.e. from a handler).
+/// @param proactor Pointer to the proactor.
+/// @param sockfd Socket to send on.
+/// @param data Bytes to send; copied before returning.
+/// @param len Number of bytes.
+/// @return 0 on success, -1 on failure.
+int uringSend(void* proactor, int sockfd, const char* data, size_t len);
+
+/// @brief Bytes queued on a connection that the socket has not taken yet.
+/// Must be called on the proactor thread (i.e. from a handler).
+/// @param proactor Pointer to the proactor.
+/// @param sockfd The socket.
+/// @return The number of bytes (0 for an unknown socket).
+size_t uringPendingOutput(void* proactor, int sockfd);
+
+/// @brief Closes a connection once its queued sends have completed.
+/// Must be called on the proactor thread (i.e. from a handler).
+/// @param proactor Pointer to the proactor.
+/// @param sockfd Socket to close.
+/// @return 0 on success, -1 on failure.
+int uringClose(void* proactor, int sockfd);
+
+/// @brief Runs a task on the proactor thread. Safe to call from any thread.
+/// @param proactor Pointer to the proactor.
+/// @param task Task to run.
+/// @return 0 on success, -1 on failure.
+int postToUringProactor(void* proactor, std::function<void()> task);
+
+/// @brief Stops the proactor. Safe to call from any thread.
+/// @param proactor Pointer to the proactor.
+/// @return 0 on success, -1 on failure.
+int stopUringProactor(void* proactor);
+
+#endif // URING_PROACTOR_HPP